@@ -0,0 +1,305 @@
+//
+//  selfPlayArena.cpp
+//
+//  Headless engine-vs-engine matches on the same rules::BoardState the game scene plays on. No window, no SFML.
+//  usage: selfplay_arena [--a alphabeta|mcts|mcts-uct] [--b ...] [--games N] [--jobs N]
+//                        [--movetime ms | --base ms --inc ms] [--threads-a N] [--threads-b N]
+//                        [--tt mb] [--nodes N] [--random-plies N] [--max-plies N] [--seed N]
+//                        [--csv games.csv] [--json summary.json]
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ai.hpp"
+
+namespace {
+    struct ArenaOptions {
+        std::string engineA = "alphabeta";
+        std::string engineB = "mcts";
+        unsigned int threadsA = 1;
+        unsigned int threadsB = 1;
+        int games = 100;
+        unsigned int jobs = 0; // 0 takes one per hardware thread
+        int moveTimeMs = 0; // fixed time per move, overrides the clock when set
+        int baseMs = 10000; // game clock per side
+        int incrementMs = 100;
+        size_t ttSizeMb = 16;
+        size_t mctsNodes = 1 << 18;
+        int randomPlies = 2; // random opening moves so the games differ
+        int maxPlies = 300; // draw after this many
+        uint64_t seed = 1;
+        std::string csvPath;
+        std::string jsonPath;
+    };
+
+    enum class Outcome { A_WINS, B_WINS, DRAW };
+
+    struct EngineTotals {
+        uint64_t moves = 0;
+        uint64_t nodes = 0;
+        uint64_t playouts = 0;
+        double thinkingMs = 0.0;
+    };
+
+    struct GameRecord {
+        int game = 0;
+        bool aPlaysRed = false;
+        Outcome outcome = Outcome::DRAW;
+        std::string reason;
+        int plies = 0;
+        EngineTotals a;
+        EngineTotals b;
+    };
+
+    std::unique_ptr<ai::MoveSource> makeEngine(const std::string& name, unsigned int threads, const ArenaOptions& options) {
+        if (name == "mcts" || name == "mcts-uct") {
+            ai::MctsSettings settings;
+            settings.policy = name == "mcts" ? ai::SelectionPolicy::PUCT : ai::SelectionPolicy::UCT;
+            settings.nodeLimit = options.mctsNodes;
+            settings.threadCount = threads;
+            return std::make_unique<ai::MonteCarloSearch>(settings);
+        }
+        if (name == "alphabeta") return std::make_unique<ai::AlphaBetaSearch>(options.ttSizeMb, threads);
+        return nullptr;
+    }
+
+    uint64_t nextRandom(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // one game, colors decided by the game number so every opening gets played from both sides
+    GameRecord playGame(int game, ai::MoveSource& engineA, ai::MoveSource& engineB, const ArenaOptions& options) {
+        GameRecord record;
+        record.game = game;
+        record.aPlaysRed = game % 2 == 0;
+
+        rules::BoardState board;
+        uint64_t seed = options.seed * 1000003ULL + game / 2;
+        std::vector<rules::Move> moves;
+        for (int ply = 0; ply < options.randomPlies && !board.isGameOver(); ++ply) {
+            board.generateMoves(moves);
+            if (moves.empty()) break;
+            board.makeMove(moves[nextRandom(seed) % moves.size()]);
+        }
+
+        if (auto* tree = dynamic_cast<ai::MonteCarloSearch*>(&engineA)) tree->clearTree();
+        if (auto* tree = dynamic_cast<ai::MonteCarloSearch*>(&engineB)) tree->clearTree();
+
+        std::array<double, 2> clockMs { static_cast<double>(options.baseMs), static_cast<double>(options.baseMs) };
+        for (record.plies = 0; record.plies < options.maxPlies; ++record.plies) {
+            rules::Side side = board.getSideToMove();
+            bool aToMove = (side == rules::Side::RED) == record.aPlaysRed;
+            if (board.hasReachedGoal(rules::opponent(side))) {
+                record.outcome = aToMove ? Outcome::B_WINS : Outcome::A_WINS;
+                record.reason = "goal";
+                return record;
+            }
+
+            board.generateMoves(moves);
+            if (moves.empty()) { // boxed in by the other pawn with no walls left, pass
+                board.setSideToMove(rules::opponent(side));
+                continue;
+            }
+
+            // time control: fixed per move, or a slice of the clock plus the increment
+            double& clock = clockMs[static_cast<int>(side)];
+            ai::SearchLimits limits;
+            limits.maxDepth = ai::MAX_PLY - 1;
+            int budget = options.moveTimeMs > 0 ? options.moveTimeMs : static_cast<int>(clock / 20.0 + options.incrementMs);
+            limits.timeBudget = std::chrono::milliseconds(std::max(1, budget));
+
+            ai::MoveSource& engine = aToMove ? engineA : engineB;
+            ai::Clock::time_point start = ai::Clock::now();
+            ai::SearchResult result = engine.search(board, limits);
+            double spentMs = std::chrono::duration<double, std::milli>(ai::Clock::now() - start).count();
+
+            EngineTotals& totals = aToMove ? record.a : record.b;
+            ++totals.moves;
+            totals.nodes += result.nodes;
+            totals.playouts += result.playouts;
+            totals.thinkingMs += spentMs;
+
+            if (options.moveTimeMs <= 0) {
+                clock -= spentMs;
+                if (clock < 0.0) {
+                    record.outcome = aToMove ? Outcome::B_WINS : Outcome::A_WINS;
+                    record.reason = "time";
+                    return record;
+                }
+                clock += options.incrementMs;
+            }
+
+            if (!result.hasMove || !board.isLegalMove(result.bestMove)) {
+                record.outcome = aToMove ? Outcome::B_WINS : Outcome::A_WINS;
+                record.reason = "illegal";
+                return record;
+            }
+            board.makeMove(result.bestMove);
+        }
+
+        record.outcome = Outcome::DRAW;
+        record.reason = "max plies";
+        return record;
+    }
+
+    // Elo difference for a score fraction, clamped away from 0 and 1 so a clean sweep stays finite
+    double eloFromScore(double score) {
+        score = std::min(std::max(score, 0.001), 0.999);
+        if (score == 0.5) return 0.0;
+        return -400.0 * std::log10(1.0 / score - 1.0);
+    }
+
+    const char* outcomeName(Outcome outcome) {
+        return outcome == Outcome::A_WINS ? "a" : (outcome == Outcome::B_WINS ? "b" : "draw");
+    }
+
+    bool parseOptions(int argc, char** argv, ArenaOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", flag.c_str());
+                return false;
+            }
+            std::string value = argv[++i];
+            if (flag == "--a") options.engineA = value;
+            else if (flag == "--b") options.engineB = value;
+            else if (flag == "--threads-a") options.threadsA = std::stoul(value);
+            else if (flag == "--threads-b") options.threadsB = std::stoul(value);
+            else if (flag == "--games") options.games = std::stoi(value);
+            else if (flag == "--jobs") options.jobs = std::stoul(value);
+            else if (flag == "--movetime") options.moveTimeMs = std::stoi(value);
+            else if (flag == "--base") options.baseMs = std::stoi(value);
+            else if (flag == "--inc") options.incrementMs = std::stoi(value);
+            else if (flag == "--tt") options.ttSizeMb = std::stoul(value);
+            else if (flag == "--nodes") options.mctsNodes = std::stoul(value);
+            else if (flag == "--random-plies") options.randomPlies = std::stoi(value);
+            else if (flag == "--max-plies") options.maxPlies = std::stoi(value);
+            else if (flag == "--seed") options.seed = std::stoull(value);
+            else if (flag == "--csv") options.csvPath = value;
+            else if (flag == "--json") options.jsonPath = value;
+            else {
+                std::fprintf(stderr, "unknown option %s\n", flag.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    ArenaOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) return 1;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bad option value: %s\n", e.what());
+        return 1;
+    }
+    if (!makeEngine(options.engineA, 1, options) || !makeEngine(options.engineB, 1, options)) {
+        std::fprintf(stderr, "engines are alphabeta, mcts or mcts-uct\n");
+        return 1;
+    }
+
+    unsigned int jobs = options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    jobs = std::min<unsigned int>(jobs, std::max(1, options.games));
+
+    // each job owns one engine pair and pulls game numbers until they run out
+    std::vector<GameRecord> records(std::max(0, options.games));
+    std::atomic<int> nextGame { 0 };
+    std::atomic<int> finished { 0 };
+    std::vector<std::thread> pool;
+    for (unsigned int job = 0; job < jobs; ++job) {
+        pool.emplace_back([&] {
+            std::unique_ptr<ai::MoveSource> engineA = makeEngine(options.engineA, options.threadsA, options);
+            std::unique_ptr<ai::MoveSource> engineB = makeEngine(options.engineB, options.threadsB, options);
+            for (int game = nextGame++; game < options.games; game = nextGame++) {
+                records[game] = playGame(game, *engineA, *engineB, options);
+                int done = ++finished;
+                if (done % 10 == 0 || done == options.games) std::fprintf(stderr, "\r%d / %d games", done, options.games);
+            }
+        });
+    }
+    for (std::thread& worker : pool) worker.join();
+    std::fprintf(stderr, "\n");
+
+    // score from a's side, error bars from the per-game score spread
+    int winsA = 0, winsB = 0, draws = 0;
+    EngineTotals totalA, totalB;
+    for (const GameRecord& record : records) {
+        if (record.outcome == Outcome::A_WINS) ++winsA;
+        else if (record.outcome == Outcome::B_WINS) ++winsB;
+        else ++draws;
+        for (auto [from, to] : { std::pair(&record.a, &totalA), std::pair(&record.b, &totalB) }) {
+            to->moves += from->moves;
+            to->nodes += from->nodes;
+            to->playouts += from->playouts;
+            to->thinkingMs += from->thinkingMs;
+        }
+    }
+
+    int games = std::max(1, options.games);
+    double score = (winsA + 0.5 * draws) / games;
+    double variance = (winsA * std::pow(1.0 - score, 2) + winsB * std::pow(score, 2) + draws * std::pow(0.5 - score, 2)) / games;
+    double margin = 1.96 * std::sqrt(variance / games);
+    double elo = eloFromScore(score);
+    double eloError = (eloFromScore(score + margin) - eloFromScore(score - margin)) / 2.0;
+
+    auto nps = [](const EngineTotals& totals) { return totals.thinkingMs > 0.0 ? totals.nodes / (totals.thinkingMs / 1000.0) : 0.0; };
+    auto pps = [](const EngineTotals& totals) { return totals.thinkingMs > 0.0 ? totals.playouts / (totals.thinkingMs / 1000.0) : 0.0; };
+    auto moveMs = [](const EngineTotals& totals) { return totals.moves ? totals.thinkingMs / totals.moves : 0.0; };
+
+    std::printf("%s vs %s, %d games, %u jobs\n", options.engineA.c_str(), options.engineB.c_str(), options.games, jobs);
+    std::printf("a +%d -%d =%d, win rate %.1f%%, elo %+.1f +/- %.1f\n", winsA, winsB, draws, 100.0 * score, elo, eloError);
+    std::printf("a: %.0f nps, %.0f playouts/s, %.1f ms/move\n", nps(totalA), pps(totalA), moveMs(totalA));
+    std::printf("b: %.0f nps, %.0f playouts/s, %.1f ms/move\n", nps(totalB), pps(totalB), moveMs(totalB));
+
+    if (!options.csvPath.empty()) {
+        std::ofstream csv(options.csvPath);
+        if (!csv) {
+            std::fprintf(stderr, "could not write %s\n", options.csvPath.c_str());
+        } else {
+            csv << "game,red,blue,winner,reason,plies,a_moves,a_nodes,a_playouts,a_ms,b_moves,b_nodes,b_playouts,b_ms\n";
+            for (const GameRecord& record : records) {
+                csv << record.game << ',' << (record.aPlaysRed ? options.engineA : options.engineB) << ','
+                    << (record.aPlaysRed ? options.engineB : options.engineA) << ',' << outcomeName(record.outcome) << ','
+                    << record.reason << ',' << record.plies << ',' << record.a.moves << ',' << record.a.nodes << ','
+                    << record.a.playouts << ',' << record.a.thinkingMs << ',' << record.b.moves << ',' << record.b.nodes << ','
+                    << record.b.playouts << ',' << record.b.thinkingMs << '\n';
+            }
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        if (!json) {
+            std::fprintf(stderr, "could not write %s\n", options.jsonPath.c_str());
+        } else {
+            json << "{\n"
+                 << "  \"engine_a\": \"" << options.engineA << "\",\n"
+                 << "  \"engine_b\": \"" << options.engineB << "\",\n"
+                 << "  \"games\": " << options.games << ",\n"
+                 << "  \"wins_a\": " << winsA << ",\n"
+                 << "  \"wins_b\": " << winsB << ",\n"
+                 << "  \"draws\": " << draws << ",\n"
+                 << "  \"win_rate_a\": " << score << ",\n"
+                 << "  \"elo_a\": " << elo << ",\n"
+                 << "  \"elo_error_95\": " << eloError << ",\n"
+                 << "  \"a\": { \"nps\": " << nps(totalA) << ", \"playouts_per_second\": " << pps(totalA) << ", \"ms_per_move\": " << moveMs(totalA) << " },\n"
+                 << "  \"b\": { \"nps\": " << nps(totalB) << ", \"playouts_per_second\": " << pps(totalB) << ", \"ms_per_move\": " << moveMs(totalB) << " }\n"
+                 << "}\n";
+        }
+    }
+    return 0;
+}
@@ -30,10 +30,13 @@ TextClass::TextClass(sf::Vector2f position, unsigned int size, sf::Color color,
 }
 
 // change message inside text 
-void TextClass::updateText(const std::string& newText) {
+bool TextClass::updateText(const std::string& newText) {
     if (text) {
+        if (text->getString() == newText) return false; 
         text->setString(newText); 
+        return true; 
     } else {
         log_warning("Text not initialized"); 
+        return false; 
     }
 }
\ No newline at end of file
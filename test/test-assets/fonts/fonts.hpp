@@ -24,7 +24,7 @@ public:
     ~TextClass() = default;
     bool const getVisibleState() const { return visibleState; }
     void setVisibleState(bool VisibleState){ visibleState = VisibleState; }
-    void updateText(const std::string& newText); 
+    bool updateText(const std::string& newText); // false when the text already read that
     unsigned int getSize() const { return size; }
     void setSize(int newSize){ text->setCharacterSize(newSize); }
 
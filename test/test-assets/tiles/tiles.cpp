@@ -48,6 +48,57 @@ Tile::Tile(const Tile& other)
     }
 }
  
+void TileBatch::clear() {
+    layers.clear();
+    slots.clear();
+    drawn.clear();
+}
+
+void TileBatch::add(const Tile* tile) {
+    const sf::Texture* texture = tile ? tile->getTileSprite().getTexture() : nullptr;
+    size_t layer = 0;
+    while (layer < layers.size() && layers[layer].texture != texture) ++layer;
+    if (layer == layers.size()) layers.push_back(Layer { texture, sf::VertexArray(sf::Quads) });
+
+    sf::VertexArray& quads = layers[layer].quads;
+    slots.push_back(Slot { static_cast<uint32_t>(layer), static_cast<uint32_t>(quads.getVertexCount()) });
+    drawn.push_back(0);
+    quads.resize(quads.getVertexCount() + 4);
+    update(slots.size() - 1, tile);
+}
+
+void TileBatch::update(size_t slot, const Tile* tile) {
+    const Slot& where = slots[slot];
+    sf::Vertex* quad = &layers[where.layer].quads[where.firstVertex];
+    bool visible = tile && tile->getVisibleState();
+    drawn[slot] = visible;
+    if (!visible) {
+        for (int i = 0; i < 4; ++i) quad[i] = sf::Vertex(); // zero area, draws nothing
+        return;
+    }
+
+    const sf::Sprite& sprite = tile->getTileSprite();
+    sf::IntRect rect = sprite.getTextureRect();
+    float width = static_cast<float>(std::abs(rect.width));
+    float height = static_cast<float>(std::abs(rect.height));
+    float left = static_cast<float>(rect.left);
+    float top = static_cast<float>(rect.top);
+    const sf::Transform& transform = sprite.getTransform(); // position, scale and origin like target.draw(sprite) would use
+
+    quad[0] = sf::Vertex(transform.transformPoint(sf::Vector2f(0.0f, 0.0f)), sprite.getColor(), sf::Vector2f(left, top));
+    quad[1] = sf::Vertex(transform.transformPoint(sf::Vector2f(width, 0.0f)), sprite.getColor(), sf::Vector2f(left + rect.width, top));
+    quad[2] = sf::Vertex(transform.transformPoint(sf::Vector2f(width, height)), sprite.getColor(), sf::Vector2f(left + rect.width, top + rect.height));
+    quad[3] = sf::Vertex(transform.transformPoint(sf::Vector2f(0.0f, height)), sprite.getColor(), sf::Vector2f(left, top + rect.height));
+}
+
+void TileBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    for (const Layer& layer : layers) {
+        if (!layer.texture) continue;
+        states.texture = layer.texture;
+        target.draw(layer.quads, states);
+    }
+}
+
 TileMap::TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNumber, size_t tileMapWidth, size_t tileMapHeight, float tileWidth, float tileHeight, std::filesystem::path filePath, sf::Vector2f tileMapPosition) 
     : tileTypesNumber(tileTypesNumber), tileMapWidth(tileMapWidth), tileMapHeight(tileMapHeight), tileWidth(tileWidth), tileHeight(tileHeight), tileMapPosition(tileMapPosition) {
 
@@ -86,6 +137,9 @@ TileMap::TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNu
 
         fileStream.close();
 
+        batch.clear();
+        for (const auto& tile : tiles) batch.add(tile.get());
+
         log_info("Tile map initialized successfully");
     } catch (const std::exception& e) {
         log_warning("Error in making tilemap: " + std::string(e.what()));
@@ -123,13 +177,16 @@ BoardTileMap::BoardTileMap(std::array<std::shared_ptr<Tile>, 11> tileTypesArr, s
     sf::Vector2i borderShortSize = sf::Vector2i{11, 9};    // short part of border
     sf::Vector2i borderTopBottomSize = sf::Vector2i{23, 9}; // top and bottom of border
     
-    float currentY = 32.0f; // Start pixels higher
+    float currentY = boardOrigin.y; // Start pixels higher
+    rowOffsets.assign(rowsTotal + 1, 0.0f);
+    colOffsets.assign(rowsTotal * (colsTotal + 1), 0.0f);
     
     // Initialize the 19x21 board (removed first and last rows, and row 18)
     for(int row = 0; row < rowsTotal; ++row) {
         int rowStart = row * colsTotal;
-        float currentX = -15.0f; // Start pixels to the left
+        float currentX = boardOrigin.x; // Start pixels to the left
         float maxRowHeight = 0.0f; // Track the tallest tile in this row
+        rowOffsets[row] = currentY - boardOrigin.y;
         
         for(int col = 0; col < colsTotal; ++col) {
             std::shared_ptr<Tile> selectedTile;
@@ -222,22 +279,40 @@ BoardTileMap::BoardTileMap(std::array<std::shared_ptr<Tile>, 11> tileTypesArr, s
                 tiles[rowStart + col]->getTileSprite().setPosition(currentX, currentY);
             }
             
+            colOffsets[row * (colsTotal + 1) + col] = currentX - boardOrigin.x;
             currentX += tileSize.x;
             
             // Track the tallest tile in this row for proper row advancement
             maxRowHeight = std::max(maxRowHeight, static_cast<float>(tileSize.y));
         }
+        colOffsets[row * (colsTotal + 1) + colsTotal] = currentX - boardOrigin.x;
         
         // Move to next row position using the actual tallest tile in this row
         currentY += maxRowHeight;
     }
+    rowOffsets[rowsTotal] = currentY - boardOrigin.y;
+
+    blockedTiles.assign(rowsTotal * colsTotal, 0);
+    solidTiles.assign(rowsTotal * colsTotal, 1);
+    for (size_t i = 0; i < blockedTiles.size(); ++i) {
+        blockedTiles[i] = tiles[i] && tiles[i]->getVisibleState() && !tiles[i]->getWalkable();
+        solidTiles[i] = !tiles[i] || !tiles[i]->getWalkable();
+    }
+    syncTilesFromBoard(); 
+    pathOracle.rebuild(boardState);
+
+    batch.clear();
+    for (const auto& tile : tiles) batch.add(tile.get());
     log_info("Boardtilemap initialized"); 
 }
 
 void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    for (const auto& tile : tiles) {
-        if (tile && tile->getVisibleState()) target.draw(tile->getTileSprite(), states);
+    if (batch.size() != tiles.size()) { // tiles appended after construction
+        batch.clear();
+        for (const auto& tile : tiles) batch.add(tile.get());
     }
+    for (size_t i = 0; i < tiles.size(); ++i) batch.syncVisibility(i, tiles[i].get());
+    batch.draw(target, states);
 }
 
 // Add a tile to the map at the specified grid position (x, y)
@@ -260,6 +335,7 @@ void TileMap::addTile(unsigned int x, unsigned int y, std::unique_ptr<Tile> tile
 
         // Optionally set the position of the tile if the Tile class has a method for that
         tiles[index]->getTileSprite().setPosition(tileMapPosition.x + x * tileWidth, tileMapPosition.y + y * tileHeight);
+        if (index < batch.size()) batch.update(index, tiles[index].get());
     } catch (const std::exception& e) {
         log_error(e.what()); // Log any exceptions that occur
     }
@@ -284,182 +360,63 @@ std::shared_ptr<Tile>& BoardTileMap::getTile(size_t index) {
 }
 
 void BoardTileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    for (const auto& tile : tiles) {
-        if (tile && tile->getVisibleState()) target.draw(tile->getTileSprite(), states);
-    }
+    for (size_t i = 0; i < tiles.size(); ++i) batch.syncVisibility(i, tiles[i].get());
+    batch.draw(target, states);
 }
 
-size_t BoardTileMap::getTileIndex(sf::Vector2i position) {
+void BoardTileMap::refreshTileQuad(size_t index) {
+    if (index < tiles.size()) batch.update(index, tiles[index].get());
+}
+
+std::optional<size_t> BoardTileMap::getTileIndex(sf::Vector2i position) const {
     return getTileIndex(sf::Vector2f(static_cast<float>(position.x), static_cast<float>(position.y)));
 }
 
-size_t BoardTileMap::getTileIndex(sf::Vector2f position) {
-    // Starting position offset (same as in constructor)
-    float startX = -15.0f;
-    float startY = 32.0f;
-    
+std::optional<size_t> BoardTileMap::getTileIndex(sf::Vector2f position) const {
     // Adjust position relative to the tilemap's starting position
-    float relativeX = position.x - startX;
-    float relativeY = position.y - startY;
-    
-    // If position is before the tilemap starts, return invalid index
-    if (relativeX < 0 || relativeY < 0) {
-        throw std::out_of_range("Position is before tilemap bounds" + std::to_string(position.x) + ", " + std::to_string(position.y));
-    }
-    
-    // Find the row by iterating through row heights
-    float currentY = 0.0f;
-    int targetRow = -1;
-    
-    for (int row = 0; row < rowsTotal; ++row) {
-        float maxRowHeight = 0.0f;
-        
-        // Calculate the tallest tile height in this row
-        for (int col = 0; col < colsTotal; ++col) {
-            sf::Vector2i tileSize;
-            
-            // Determine tile size based on position (same logic as constructor)
-            // Updated for 19x21 grid: rows 0 and 18 are borders
-            if (row == 0 || row == 18) { // Top/bottom border
-                tileSize = sf::Vector2i{23, 9}; // borderTopBottomSize
-            }
-            else if (col == 0 || col == 20) { // Left/right border
-                if ((row - 1) % 2 == 0) {
-                    tileSize = sf::Vector2i{11, 33}; // borderLongSize
-                } else {
-                    tileSize = sf::Vector2i{11, 9}; // borderShortSize
-                }
-            }
-            else { // Interior tiles
-                int originalRow = row - 1;
-                int originalCol = col - 1;
-                
-                if (originalRow % 2 == 0) {
-                    if (originalCol == 0 || originalCol == 18) {
-                        tileSize = goalTileSize; // sf::Vector2i{46, 33}
-                    }
-                    else if (originalCol == 1) {
-                        tileSize = pathTileSize; // sf::Vector2i{33, 33}
-                    }
-                    else {
-                        if (originalCol % 2 == 0) {
-                            tileSize = wallTileYSize; // sf::Vector2i{9, 33}
-                        } else {
-                            tileSize = pathTileSize; // sf::Vector2i{33, 33}
-                        }
-                    }
-                }
-                else {
-                    if (originalCol == 0) {
-                        tileSize = blankp1TileSize; // sf::Vector2i{46, 9}
-                    }
-                    else if (originalCol == 18) {
-                        tileSize = blankp2TileSize; // sf::Vector2i{46, 9}
-                    }
-                    else {
-                        if (originalCol % 2 == 1) {
-                            tileSize = wallTileXSize; // sf::Vector2i{33, 9}
-                        } else {
-                            tileSize = blankWallTileSize; // sf::Vector2i{9, 9}
-                        }
-                    }
-                }
-            }
-            
-            maxRowHeight = std::max(maxRowHeight, static_cast<float>(tileSize.y));
-        }
-        
-        // Check if the Y position falls within this row
-        if (relativeY >= currentY && relativeY < currentY + maxRowHeight) {
-            targetRow = row;
-            break;
-        }
-        
-        currentY += maxRowHeight;
-    }
-    
-    // If no row was found, position is beyond tilemap bounds
-    if (targetRow == -1) {
-        throw std::out_of_range("Position is beyond tilemap bounds");
-    }
-    
-    // Now find the column within the target row
-    float currentX = 0.0f;
-    int targetCol = -1;
-    
-    for (int col = 0; col < colsTotal; ++col) {
-        sf::Vector2i tileSize;
-        
-        // Determine tile size for this specific tile (same logic as above)
-        // Updated for 19x21 grid: rows 0 and 18 are borders
-        if (targetRow == 0 || targetRow == 18) { // Top/bottom border
-            tileSize = sf::Vector2i{23, 9};
-        }
-        else if (col == 0 || col == 20) { // Left/right border
-            if ((targetRow - 1) % 2 == 0) {
-                tileSize = sf::Vector2i{11, 33};
-            } else {
-                tileSize = sf::Vector2i{11, 9};
-            }
-        }
-        else { // Interior tiles
-            int originalRow = targetRow - 1;
-            int originalCol = col - 1;
-            
-            if (originalRow % 2 == 0) {
-                if (originalCol == 0 || originalCol == 18) {
-                    tileSize = goalTileSize;
-                }
-                else if (originalCol == 1) {
-                    tileSize = pathTileSize;
-                }
-                else {
-                    if (originalCol % 2 == 0) {
-                        tileSize = wallTileYSize;
-                    } else {
-                        tileSize = pathTileSize;
-                    }
-                }
-            }
-            else {
-                if (originalCol == 0) {
-                    tileSize = blankp1TileSize;
-                }
-                else if (originalCol == 18) {
-                    tileSize = blankp2TileSize;
-                }
-                else {
-                    if (originalCol % 2 == 1) {
-                        tileSize = wallTileXSize;
-                    } else {
-                        tileSize = blankWallTileSize;
-                    }
-                }
-            }
-        }
-        
-        // Check if the X position falls within this column
-        if (relativeX >= currentX && relativeX < currentX + tileSize.x) {
-            targetCol = col;
-            break;
-        }
-        currentX += tileSize.x;
-    }
-    
-    // If no column was found, position is beyond tilemap bounds
-    if (targetCol == -1) {
-        throw std::out_of_range("Position is beyond tilemap bounds");
-    }
-    
-    // Calculate and return the tile index
-    size_t index = targetRow * 21 + targetCol;
-    
-    // Ensure index is within valid range
-    if (index >= tiles.size()) {
-        throw std::out_of_range("Calculated tile index is out of bounds");
+    float relativeX = position.x - boardOrigin.x;
+    float relativeY = position.y - boardOrigin.y;
+
+    if (relativeX < 0 || relativeY < 0 || relativeY >= rowOffsets.back()) return std::nullopt;
+
+    // row whose [offset, next offset) span holds the point, then the same within that row's column offsets
+    size_t row = std::upper_bound(rowOffsets.begin(), rowOffsets.end(), relativeY) - rowOffsets.begin() - 1;
+
+    auto rowBegin = colOffsets.begin() + row * (colsTotal + 1);
+    auto rowEnd = rowBegin + colsTotal + 1;
+    if (relativeX >= *(rowEnd - 1)) return std::nullopt;
+
+    size_t col = std::upper_bound(rowBegin, rowEnd, relativeX) - rowBegin - 1;
+    return row * colsTotal + col;
+}
+
+void BoardTileMap::setTileWalkable(size_t index, bool walkable) {
+    if (index >= tiles.size() || !tiles[index]) return;
+    if (tiles[index]->getWalkable() != walkable) ++wallVersion;
+    tiles[index]->setWalkable(walkable);
+    blockedTiles[index] = tiles[index]->getVisibleState() && !walkable;
+    solidTiles[index] = !walkable;
+}
+
+int BoardTileMap::countBlockedTiles(sf::FloatRect area) const {
+    float left = area.left - boardOrigin.x, right = left + area.width;
+    float top = area.top - boardOrigin.y, bottom = top + area.height;
+    if (right <= 0 || bottom <= 0 || left >= colOffsets[colsTotal] || top >= rowOffsets.back()) return 0;
+
+    // rows/cols whose span overlaps the box, strict like sf::FloatRect::intersects
+    size_t firstRow = std::max<std::ptrdiff_t>(0, std::upper_bound(rowOffsets.begin(), rowOffsets.end(), top) - rowOffsets.begin() - 1);
+    size_t lastRow = std::min<std::ptrdiff_t>(rowsTotal, std::lower_bound(rowOffsets.begin(), rowOffsets.end(), bottom) - rowOffsets.begin());
+
+    int blockedCount = 0;
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        auto rowBegin = colOffsets.begin() + row * (colsTotal + 1);
+        auto rowEnd = rowBegin + colsTotal + 1;
+        size_t firstCol = std::max<std::ptrdiff_t>(0, std::upper_bound(rowBegin, rowEnd, left) - rowBegin - 1);
+        size_t lastCol = std::min<std::ptrdiff_t>(colsTotal, std::lower_bound(rowBegin, rowEnd, right) - rowBegin);
+
+        for (size_t col = firstCol; col < lastCol; ++col) blockedCount += blockedTiles[row * colsTotal + col];
     }
-    
-    return index;
+    return blockedCount;
 }
 
 bool BoardTileMap::isGreyTile(size_t index) const {
@@ -546,4 +503,93 @@ bool BoardTileMap::isP2StartTile(size_t index) const {
     // Check if it's in P2's starting column (last column before right border)
     // and not in the top or bottom border rows
     return (col == 19 && row > 0 && row < 18);  // 21 columns, 19 rows with borders
-}
\ No newline at end of file
+}
+int BoardTileMap::getBoardCell(size_t index) const {
+    if (index >= tiles.size()) return -1;
+
+    int rows = rowsTotal, cols = colsTotal;
+    int row = index / cols;
+    int col = index % cols;
+    if (row == 0 || row == rows - 1) return -1; // top and bottom border
+
+    // start strips are one long tile column, clamp to the pawn row beside it
+    if (col == 1 || col == cols - 2) {
+        int cellRow = std::min((row - 1) / 2, rules::BOARD_SIZE - 1);
+        return rules::cellIndex(cellRow, col == 1 ? 0 : rules::BOARD_SIZE - 1);
+    }
+
+    // path tiles sit on odd rows and even columns (2, 4, ... 18)
+    if (row % 2 == 0 || col % 2 == 1 || col < 2 || col > cols - 3) return -1;
+    return rules::cellIndex((row - 1) / 2, (col - 2) / 2);
+}
+
+size_t BoardTileMap::getCellTileIndex(int cell) const {
+    return (1 + 2 * rules::cellRow(cell)) * colsTotal + 2 + 2 * rules::cellCol(cell);
+}
+
+std::optional<rules::Move> BoardTileMap::getWallMove(size_t index) const {
+    if (index >= tiles.size()) return std::nullopt;
+
+    int row = index / colsTotal;
+    int col = index % colsTotal;
+
+    // horizontal walls span three tiles to the right starting at a wall x tile (even row, even column)
+    if (row % 2 == 0 && col % 2 == 0) {
+        int slotRow = (row - 2) / 2, slotCol = (col - 2) / 2;
+        if (row < 2 || col < 2 || slotRow >= rules::WALL_SIZE || slotCol >= rules::WALL_SIZE) return std::nullopt;
+        return rules::Move{ rules::MoveType::HORIZONTAL_WALL, static_cast<uint8_t>(rules::slotIndex(slotRow, slotCol)) };
+    }
+    // vertical walls span three tiles downwards starting at a wall y tile (odd row, odd column)
+    if (row % 2 == 1 && col % 2 == 1) {
+        int slotRow = (row - 1) / 2, slotCol = (col - 3) / 2;
+        if (col < 3 || slotRow >= rules::WALL_SIZE || slotCol >= rules::WALL_SIZE) return std::nullopt;
+        return rules::Move{ rules::MoveType::VERTICAL_WALL, static_cast<uint8_t>(rules::slotIndex(slotRow, slotCol)) };
+    }
+    return std::nullopt;
+}
+
+std::array<size_t, 3> BoardTileMap::getWallTileIndices(const rules::Move& wallMove) const {
+    int slotRow = wallMove.index / rules::WALL_SIZE;
+    int slotCol = wallMove.index % rules::WALL_SIZE;
+
+    if (wallMove.type == rules::MoveType::HORIZONTAL_WALL) {
+        size_t base = (2 + 2 * slotRow) * colsTotal + 2 + 2 * slotCol;
+        return { base, base + 1, base + 2 };
+    }
+    size_t base = (1 + 2 * slotRow) * colsTotal + 3 + 2 * slotCol;
+    return { base, base + colsTotal, base + 2 * colsTotal };
+}
+
+bool BoardTileMap::placeWall(rules::Side side, const rules::Move& wallMove) {
+    if (!wallMove.isWall() || boardState.getWallsLeft(side) <= 0 || !boardState.isWallPlaceable(wallMove.type, wallMove.index)) return false;
+    if (!pathOracle.keepsBothExits(boardState, wallMove.type, wallMove.index)) return false;
+
+    boardState.placeWall(side, wallMove.type, wallMove.index);
+    pathOracle.onWallPlaced(boardState, wallMove.type, wallMove.index);
+    for (size_t tileIndex : getWallTileIndices(wallMove)) setTileWalkable(tileIndex, false);
+    return true;
+}
+
+void BoardTileMap::syncPawn(rules::Side side, size_t index) {
+    int cell = getBoardCell(index);
+    if (cell >= 0) boardState.setPawn(side, static_cast<uint8_t>(cell));
+}
+
+void BoardTileMap::syncTilesFromBoard() {
+    // clear every slot first, neighbouring slots share their end tiles
+    for (rules::MoveType orientation : { rules::MoveType::HORIZONTAL_WALL, rules::MoveType::VERTICAL_WALL }) {
+        for (int slot = 0; slot < rules::SLOT_COUNT; ++slot) {
+            for (size_t tileIndex : getWallTileIndices(rules::Move{ orientation, static_cast<uint8_t>(slot) })) {
+                setTileWalkable(tileIndex, true);
+            }
+        }
+    }
+    for (rules::MoveType orientation : { rules::MoveType::HORIZONTAL_WALL, rules::MoveType::VERTICAL_WALL }) {
+        for (int slot = 0; slot < rules::SLOT_COUNT; ++slot) {
+            if (!boardState.hasWall(orientation, slot)) continue;
+            for (size_t tileIndex : getWallTileIndices(rules::Move{ orientation, static_cast<uint8_t>(slot) })) {
+                setTileWalkable(tileIndex, false);
+            }
+        }
+    }
+}
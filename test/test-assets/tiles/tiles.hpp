@@ -12,8 +12,12 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <optional>
+#include <algorithm>
+#include <cstdlib>
 
 #include "../../test-logging/log.hpp"
+#include "../../test-src/game/rules/rules.hpp"
 
 
 class Tile {
@@ -49,6 +53,32 @@ private:
     bool visibleState {};
 };
 
+// Tile quads in one vertex array per texture, so a whole map is a handful of draw calls instead of one per tile.
+// Each tile owns a fixed slot; a quad is rewritten only when its tile's visibility flips or update() is called for it
+class TileBatch {
+public:
+    void clear();
+    void add(const Tile* tile); // next slot, in the owner's tile order
+    void update(size_t slot, const Tile* tile); // re-reads position, rect, color and visibility, hidden or null tiles collapse to nothing
+    void syncVisibility(size_t slot, const Tile* tile) { if ((tile && tile->getVisibleState()) != (drawn[slot] != 0)) update(slot, tile); }
+    size_t size() const { return slots.size(); }
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const; // one call per texture
+
+private:
+    struct Layer {
+        const sf::Texture* texture = nullptr;
+        sf::VertexArray quads { sf::Quads };
+    };
+    struct Slot {
+        uint32_t layer = 0;
+        uint32_t firstVertex = 0;
+    };
+
+    std::vector<Layer> layers;
+    std::vector<Slot> slots;
+    std::vector<uint8_t> drawn; // visibility the slot's quad was last written with
+};
+
 class TileMap : public sf::Drawable {
 public:
     // Constructor now accepts a shared_ptr to a default tile, and initializes the map with it
@@ -79,6 +109,7 @@ private:
     std::vector<std::unique_ptr<Tile>> tiles; 
     sf::Vector2f tileMapPosition; 
     bool visibleState = true;
+    mutable TileBatch batch; // visibility is synced lazily in draw
 
     // Override the draw function of sf::Drawable to draw all tiles
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
@@ -90,18 +121,54 @@ public:
     bool const getVisibleState() const { return true; } // entire board, not each tiles
     std::shared_ptr<Tile>& getTile(size_t index);
     size_t getTileMapNumber() const { return tiles.size(); } // returns the number of tiles in the board (483)
-    size_t getTileIndex(sf::Vector2i position); 
-    size_t getTileIndex(sf::Vector2f postiion);
+    std::optional<size_t> getTileIndex(sf::Vector2i position) const; // nullopt when the point is off the board
+    std::optional<size_t> getTileIndex(sf::Vector2f position) const;
     bool isGreyTile(size_t index) const; 
     bool isVerticalWallTile(size_t index) const;
     bool isP1StartTile(size_t index) const;
     bool isP2StartTile(size_t index) const;
 
+    // walkability grid, one byte per tile, so movement checks only visit the tiles under a box
+    void setTileWalkable(size_t index, bool walkable); // use instead of Tile::setWalkable so the grid stays in step
+    bool isTileBlocked(size_t index) const { return blockedTiles[index] != 0; }
+    int countBlockedTiles(sf::FloatRect area) const; // blocked tiles overlapping area (world coordinates)
+    uint64_t getWallVersion() const { return wallVersion; } // bumped whenever a tile's walkability changes, for caches of anything ray traced
+
+    // grid geometry for ray traversal, offsets are relative to getBoardOrigin()
+    sf::Vector2f getBoardOrigin() const { return boardOrigin; }
+    size_t getRowsTotal() const { return rowsTotal; }
+    size_t getColsTotal() const { return colsTotal; }
+    const std::vector<float>& getRowOffsets() const { return rowOffsets; }
+    const float* getColOffsets(size_t row) const { return colOffsets.data() + row * (colsTotal + 1); } // colsTotal + 1 entries
+    bool isTileWalkable(size_t index) const { return solidTiles[index] == 0; } // one byte load, no pointer chasing in the ray loop
+
+    // rules engine behind the board, tile walkability is derived from its wall sets
+    rules::BoardState& getBoardState() { return boardState; }
+    const rules::BoardState& getBoardState() const { return boardState; }
+    const rules::PathOracle& getPathOracle() const { return pathOracle; } // distance fields, updated on every placeWall
+    int getBoardCell(size_t index) const; // pawn cell under a tile, -1 for walls and borders. start strips count as the nearest column
+    size_t getCellTileIndex(int cell) const;
+    std::optional<rules::Move> getWallMove(size_t index) const; // wall whose top/left tile is index
+    std::array<size_t, 3> getWallTileIndices(const rules::Move& wallMove) const;
+    bool placeWall(rules::Side side, const rules::Move& wallMove); // false if the slot overlaps or crosses another wall or seals a pawn in
+    void syncPawn(rules::Side side, size_t index); // no-op unless the tile is a pawn cell
+    void syncTilesFromBoard();
+    void refreshTileQuad(size_t index); // after changing a tile's sprite directly (position, rect, color)
+
 private:
+    rules::BoardState boardState;
+    rules::PathOracle pathOracle;
     size_t rowsTotal {};
     size_t colsTotal {};
+    sf::Vector2f boardOrigin { -15.0f, 32.0f }; // top left of the board in world coordinates
+    std::vector<float> rowOffsets; // prefix sums of row heights, rowsTotal + 1 entries
+    std::vector<float> colOffsets; // prefix sums of tile widths per row, (colsTotal + 1) entries per row since rows use different widths
+    std::vector<uint8_t> blockedTiles; // 1 if the tile is visible and not walkable
+    std::vector<uint8_t> solidTiles; // 1 if the tile is missing or not walkable, visible or not
+    uint64_t wallVersion = 0;
     std::array<std::shared_ptr<Tile>, 399> tiles; // board with 19 x 21 tiles including walls
     std::array<std::shared_ptr<Tile>, 11> tileTypesArr; // wall, path, goal, additional tile type
+    mutable TileBatch batch; // all 399 tiles, visibility is synced lazily in draw
     sf::Vector2i wallTileXSize; 
     sf::Vector2i wallTileYSize;
     sf::Vector2i blankWallTileSize;
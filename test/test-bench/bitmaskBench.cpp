@@ -0,0 +1,235 @@
+//
+//  bitmaskBench.cpp
+//
+//  Pixel perfect overlap of two masks: the old per-pixel loop against the packed word test, scalar and AVX2.
+//  Every word result is checked against a pixel by pixel reading of the same packed masks. Rotated pawns last: the old
+//  trig per pixel loop against the cached turned masks, which are checked against turning each pixel back by hand.
+//  usage: bitmask_bench [tests]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "bitmask.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Mask {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        std::shared_ptr<uint8_t[]> packed;
+        std::vector<uint8_t> perPixel; // the layout the old loop read, 4 bytes a pixel and 1 where it's set
+    };
+
+    struct Placement {
+        int x1, y1, x2, y2;
+    };
+
+    // ellipse with ragged edges, roughly what a sprite's alpha looks like
+    Mask makeMask(unsigned int width, unsigned int height, std::mt19937& rng) {
+        Mask mask;
+        mask.width = width;
+        mask.height = height;
+        mask.packed = bitmask::allocate(width, height);
+        mask.perPixel.assign(static_cast<size_t>(width) * height * 4, 0);
+        std::uniform_real_distribution<float> noise(0.85f, 1.0f);
+        for (unsigned int y = 0; y < height; ++y) {
+            for (unsigned int x = 0; x < width; ++x) {
+                float dx = (x + 0.5f) / width * 2.0f - 1.0f;
+                float dy = (y + 0.5f) / height * 2.0f - 1.0f;
+                if (dx * dx + dy * dy > noise(rng)) continue;
+                bitmask::setPixel(mask.packed.get(), width, x, y);
+                mask.perPixel[(static_cast<size_t>(y) * width + x) * 4] = 1;
+            }
+        }
+        return mask;
+    }
+
+    // the collision loop pixelPerfectCollision used before the packed masks
+    bool perPixelOverlap(const Mask& a, const Mask& b, const Placement& at) {
+        int left = std::max(at.x1, at.x2);
+        int top = std::max(at.y1, at.y2);
+        int right = std::min(at.x1 + static_cast<int>(a.width), at.x2 + static_cast<int>(b.width));
+        int bottom = std::min(at.y1 + static_cast<int>(a.height), at.y2 + static_cast<int>(b.height));
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                int index1 = ((y - at.y1) * static_cast<int>(a.width) + (x - at.x1)) * 4;
+                int index2 = ((y - at.y2) * static_cast<int>(b.width) + (x - at.x2)) * 4;
+                if (a.perPixel[index1] == 1 && b.perPixel[index2] == 1) return true;
+            }
+        }
+        return false;
+    }
+
+    bool packedReference(const Mask& a, const Mask& b, const Placement& at) {
+        int left = std::max(at.x1, at.x2);
+        int top = std::max(at.y1, at.y2);
+        int right = std::min(at.x1 + static_cast<int>(a.width), at.x2 + static_cast<int>(b.width));
+        int bottom = std::min(at.y1 + static_cast<int>(a.height), at.y2 + static_cast<int>(b.height));
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                if (bitmask::getPixel(a.packed.get(), a.width, x - at.x1, y - at.y1) &&
+                    bitmask::getPixel(b.packed.get(), b.width, x - at.x2, y - at.y2)) return true;
+            }
+        }
+        return false;
+    }
+
+    bool wordOverlap(const Mask& a, const Mask& b, const Placement& at) {
+        return bitmask::overlaps(a.packed.get(), at.x1, at.y1, a.width, a.height, b.packed.get(), at.x2, at.y2, b.width, b.height);
+    }
+
+    // the rotated collision loop before the cached turned masks, two sin/cos pairs per pixel of the overlap
+    bool trigOverlap(const Mask& a, const Mask& b, const Placement& at, float angle1, float angle2) {
+        int left = std::max(at.x1, at.x2);
+        int top = std::max(at.y1, at.y2);
+        int right = std::min(at.x1 + static_cast<int>(a.width), at.x2 + static_cast<int>(b.width));
+        int bottom = std::min(at.y1 + static_cast<int>(a.height), at.y2 + static_cast<int>(b.height));
+        auto solid = [](const Mask& mask, float x, float y, float angle) {
+            float rad = -angle * 3.14159f / 180.0f;
+            int rx = static_cast<int>(x * std::cos(rad) - y * std::sin(rad));
+            int ry = static_cast<int>(x * std::sin(rad) + y * std::cos(rad));
+            if (rx < 0 || ry < 0 || rx >= static_cast<int>(mask.width) || ry >= static_cast<int>(mask.height)) return false;
+            return bitmask::getPixel(mask.packed.get(), mask.width, rx, ry);
+        };
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                if (solid(a, x - at.x1, y - at.y1, angle1) && solid(b, x - at.x2, y - at.y2, angle2)) return true;
+            }
+        }
+        return false;
+    }
+
+    bool cachedRotatedOverlap(const Mask& a, const Mask& b, const Placement& at, float angle1, float angle2) {
+        bitmask::RotatedMaskCache& cache = bitmask::getRotatedMaskCache();
+        auto rotated1 = cache.get(a.packed, a.width, a.height, angle1);
+        auto rotated2 = cache.get(b.packed, b.width, b.height, angle2);
+        return bitmask::overlaps(rotated1->mask.get(), at.x1 + rotated1->offsetX, at.y1 + rotated1->offsetY, rotated1->width, rotated1->height,
+                                 rotated2->mask.get(), at.x2 + rotated2->offsetX, at.y2 + rotated2->offsetY, rotated2->width, rotated2->height);
+    }
+
+    // what the turned masks should give: each pixel near both masks turned back about each mask's centre at the
+    // snapped angle and looked up in the unrotated mask
+    bool rotatedReference(const Mask& a, const Mask& b, const Placement& at, float angle1, float angle2) {
+        struct Turned {
+            const Mask* mask;
+            double centreX, centreY, cosAngle, sinAngle;
+            bool solid(int x, int y) const {
+                double dx = x + 0.5 - centreX;
+                double dy = y + 0.5 - centreY;
+                double sourceX = std::floor(cosAngle * dx + sinAngle * dy + mask->width * 0.5);
+                double sourceY = std::floor(-sinAngle * dx + cosAngle * dy + mask->height * 0.5);
+                if (sourceX < 0.0 || sourceY < 0.0 || sourceX >= mask->width || sourceY >= mask->height) return false;
+                return bitmask::getPixel(mask->packed.get(), mask->width, static_cast<unsigned int>(sourceX), static_cast<unsigned int>(sourceY));
+            }
+        };
+        auto turn = [](const Mask& mask, int x, int y, float degrees) {
+            double radians = bitmask::getAngleIndex(degrees) * 2.0 * 3.14159265358979 / bitmask::ANGLE_STEPS;
+            return Turned { &mask, x + mask.width * 0.5, y + mask.height * 0.5, std::cos(radians), std::sin(radians) };
+        };
+        Turned first = turn(a, at.x1, at.y1, angle1);
+        Turned second = turn(b, at.x2, at.y2, angle2);
+
+        // squares around each centre that hold the mask at any angle
+        double reach1 = std::hypot(a.width, a.height) * 0.5 + 1.0;
+        double reach2 = std::hypot(b.width, b.height) * 0.5 + 1.0;
+        int left = static_cast<int>(std::floor(std::max(first.centreX - reach1, second.centreX - reach2)));
+        int right = static_cast<int>(std::ceil(std::min(first.centreX + reach1, second.centreX + reach2)));
+        int top = static_cast<int>(std::floor(std::max(first.centreY - reach1, second.centreY - reach2)));
+        int bottom = static_cast<int>(std::ceil(std::min(first.centreY + reach1, second.centreY + reach2)));
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                if (first.solid(x, y) && second.solid(x, y)) return true;
+            }
+        }
+        return false;
+    }
+
+    double timeTests(const std::function<bool(const Mask&, const Mask&, const Placement&)>& test, const Mask& a, const Mask& b,
+                     const std::vector<Placement>& placements, std::vector<uint8_t>& results) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < placements.size(); ++i) results[i] = test(a, b, placements[i]);
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / placements.size();
+    }
+}
+
+int main(int argc, char** argv) {
+    int tests = argc > 1 ? std::atoi(argv[1]) : 20000;
+    bool wide = bitmask::hasWidePath();
+
+    std::printf("%d placements per size, avx2 %s\n", tests, wide ? "on" : "off");
+    std::printf("%10s %10s %12s %10s %12s\n", "size", "path", "ns/test", "speedup", "mismatches");
+
+    std::mt19937 rng(5);
+    for (auto size : { std::make_pair(31u, 31u), std::make_pair(192u, 76u), std::make_pair(576u, 228u) }) {
+        Mask a = makeMask(size.first, size.second, rng);
+        Mask b = makeMask(size.first, size.second, rng);
+
+        // b anywhere it still touches a's box, plenty of near misses around the rounded corners
+        std::vector<Placement> placements(tests);
+        std::uniform_int_distribution<int> dx(-static_cast<int>(size.first) + 1, static_cast<int>(size.first) - 1);
+        std::uniform_int_distribution<int> dy(-static_cast<int>(size.second) + 1, static_cast<int>(size.second) - 1);
+        for (Placement& at : placements) at = { 100, 100, 100 + dx(rng), 100 + dy(rng) };
+
+        std::vector<uint8_t> reference(tests);
+        std::vector<uint8_t> results(tests);
+        timeTests(packedReference, a, b, placements, reference);
+        double legacyNs = timeTests(perPixelOverlap, a, b, placements, results);
+
+        auto report = [&](const char* path, double ns) {
+            size_t mismatches = 0;
+            for (int i = 0; i < tests; ++i) mismatches += results[i] != reference[i];
+            std::printf("%4ux%-5u %10s %12.1f %9.2fx %12zu\n", size.first, size.second, path, ns, legacyNs / ns, mismatches);
+        };
+        report("per-pixel", legacyNs);
+
+        bitmask::setWidePathEnabled(false);
+        report("words", timeTests(wordOverlap, a, b, placements, results));
+        if (wide) {
+            bitmask::setWidePathEnabled(true);
+            report("avx2", timeTests(wordOverlap, a, b, placements, results));
+        }
+    }
+
+    // pawns at any angle, the turned masks snap to the nearest 3 degrees. The old loop turned about the top left
+    // corner rather than the centre, so it only compares on time
+    Mask a = makeMask(31, 31, rng);
+    Mask b = makeMask(31, 31, rng);
+    std::vector<Placement> placements(tests);
+    std::vector<std::pair<float, float>> angles(tests);
+    std::uniform_int_distribution<int> offset(-44, 44);
+    std::uniform_real_distribution<float> angle(-360.0f, 720.0f);
+    for (int i = 0; i < tests; ++i) {
+        placements[i] = { 100, 100, 100 + offset(rng), 100 + offset(rng) };
+        angles[i] = { angle(rng), angle(rng) };
+    }
+    std::vector<uint8_t> reference(tests);
+    std::vector<uint8_t> results(tests);
+    auto timeRotated = [&](bool (*test)(const Mask&, const Mask&, const Placement&, float, float), std::vector<uint8_t>& out) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < tests; ++i) out[i] = test(a, b, placements[i], angles[i].first, angles[i].second);
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / tests;
+    };
+    bitmask::getRotatedMaskCache().warm(a.packed, a.width, a.height); // what makeRectsAndBitmasks does for the pawns
+    bitmask::getRotatedMaskCache().warm(b.packed, b.width, b.height);
+    timeRotated(rotatedReference, reference);
+    double trigNs = timeRotated(trigOverlap, results);
+    double cachedNs = timeRotated(cachedRotatedOverlap, results);
+    size_t mismatches = 0;
+    size_t hits = 0;
+    for (int i = 0; i < tests; ++i) {
+        mismatches += results[i] != reference[i];
+        hits += reference[i];
+    }
+    std::printf("%4ux%-5u %10s %12.1f %9.2fx %12s\n", 31u, 31u, "trig", trigNs, 1.0, "-");
+    std::printf("%4ux%-5u %10s %12.1f %9.2fx %12zu\n", 31u, 31u, "turned", cachedNs, trigNs / cachedNs, mismatches);
+    std::printf("turned placements overlapping: %zu of %d\n", hits, tests);
+    return 0;
+}
@@ -0,0 +1,108 @@
+//
+//  quadtreeBench.cpp
+//
+//  Quadtree upkeep for a crowd of moving boxes: incremental update against clearing and reinserting every frame,
+//  plus area queries checked against a brute force scan.
+//  usage: quadtree_bench [frames]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "quadtree.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float WORLD_SIZE = 2048.0f;
+
+    struct Body {
+        sf::FloatRect bounds;
+        float velocityX = 0.0f;
+        float velocityY = 0.0f;
+    };
+
+    // the tree never dereferences what it stores, so plain bodies stand in for sprites
+    Sprite* asSprite(Body& body) { return reinterpret_cast<Sprite*>(&body); }
+    const Body& asBody(Sprite* sprite) { return *reinterpret_cast<const Body*>(sprite); }
+
+    void step(std::vector<Body>& bodies) {
+        for (Body& body : bodies) {
+            body.bounds.left += body.velocityX;
+            body.bounds.top += body.velocityY;
+            if (body.bounds.left < 0.0f || body.bounds.left + body.bounds.width > WORLD_SIZE) body.velocityX = -body.velocityX;
+            if (body.bounds.top < 0.0f || body.bounds.top + body.bounds.height > WORLD_SIZE) body.velocityY = -body.velocityY;
+        }
+    }
+
+    std::vector<Body> makeBodies(size_t count, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE - 32.0f);
+        std::uniform_real_distribution<float> size(4.0f, 24.0f);
+        std::uniform_real_distribution<float> velocity(-3.0f, 3.0f);
+        std::vector<Body> bodies(count);
+        for (Body& body : bodies) {
+            body.bounds = sf::FloatRect(position(rng), position(rng), size(rng), size(rng));
+            body.velocityX = velocity(rng);
+            body.velocityY = velocity(rng);
+        }
+        return bodies;
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+    constexpr int QUERIES_PER_FRAME = 64;
+
+    std::printf("%d frames, %d queries per frame\n", frames, QUERIES_PER_FRAME);
+    std::printf("%8s %14s %14s %10s %8s %12s %10s\n", "objects", "update ns/obj", "rebuild ns/obj", "speedup", "nodes", "query ns", "mismatches");
+
+    for (size_t count : { 1000u, 4000u, 16000u }) {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> corner(0.0f, WORLD_SIZE - 128.0f);
+        std::uniform_real_distribution<float> extent(16.0f, 128.0f);
+
+        // same motion for both trees, one keeps its objects and moves them, the other starts over each frame
+        std::vector<Body> bodies = makeBodies(count, rng);
+        physics::Quadtree incremental(0.0f, 0.0f, WORLD_SIZE, WORLD_SIZE, 0, 8, 8);
+        physics::Quadtree rebuilt(0.0f, 0.0f, WORLD_SIZE, WORLD_SIZE, 0, 8, 8);
+        for (Body& body : bodies) incremental.insert(asSprite(body), body.bounds);
+
+        double updateNs = 0.0;
+        double rebuildNs = 0.0;
+        double queryNs = 0.0;
+        size_t mismatches = 0;
+        std::vector<Sprite*> found;
+        for (int frame = 0; frame < frames; ++frame) {
+            step(bodies);
+
+            Clock::time_point start = Clock::now();
+            incremental.update([](Sprite* sprite) { return asBody(sprite).bounds; });
+            updateNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            start = Clock::now();
+            rebuilt.clear();
+            for (Body& body : bodies) rebuilt.insert(asSprite(body), body.bounds);
+            rebuildNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            for (int query = 0; query < QUERIES_PER_FRAME; ++query) {
+                sf::FloatRect area(corner(rng), corner(rng), extent(rng), extent(rng));
+                found.clear();
+                start = Clock::now();
+                incremental.query(area, found);
+                queryNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+                size_t expected = 0;
+                for (const Body& body : bodies) expected += area.intersects(body.bounds) ? 1 : 0;
+                if (found.size() != expected) ++mismatches;
+            }
+        }
+
+        double perObject = static_cast<double>(frames) * count;
+        std::printf("%8zu %14.2f %14.2f %9.2fx %8zu %12.1f %10zu\n", count, updateNs / perObject, rebuildNs / perObject,
+                    rebuildNs / updateNs, incremental.getNodeCount(), queryNs / (static_cast<double>(frames) * QUERIES_PER_FRAME), mismatches);
+    }
+    return 0;
+}
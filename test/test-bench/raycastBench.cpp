@@ -0,0 +1,174 @@
+//
+//  raycastBench.cpp
+//
+//  Ray packet kernel: directions plus wall projection for a full fan, every path this CPU runs against the scalar one.
+//  Then a pawn turning 3 degrees a key press with the shipped fan: how many rays each frame keeps from the last one.
+//  usage: raycast_bench [frames]
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "raycast.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct PathTiming {
+        double nsPerRay = 0.0;
+        float maxError = 0.0f; // largest difference from the scalar path in any output coordinate
+    };
+
+    PathTiming timePath(raycast::KernelPath path, size_t rays, int frames, const std::vector<float>& distances,
+                        const std::vector<int32_t>& sides, const raycast::WallProjection& projection,
+                        std::vector<sf::Vertex>& out, const std::vector<sf::Vertex>* reference) {
+        raycast::RayFan fan;
+        fan.resize(rays);
+
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            float heading = 0.01f * frame;
+            raycast::computeDirections(fan, heading, 60.0f / rays * 3.14159f / 180.0f, path);
+            for (size_t i = 0; i < rays; ++i) { // stands in for the traversal
+                fan.distance[i] = distances[i];
+                fan.hit[i] = distances[i] > 0.0f ? 1.0f : 0.0f;
+                fan.side[i] = sides[i];
+            }
+            raycast::projectWalls(fan, projection, out.data(), path);
+        }
+        double elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        PathTiming timing;
+        timing.nsPerRay = elapsedNs / (static_cast<double>(frames) * rays);
+        if (reference) {
+            for (size_t i = 0; i < out.size(); ++i) {
+                timing.maxError = std::max(timing.maxError, std::fabs(out[i].position.y - (*reference)[i].position.y));
+            }
+        }
+        return timing;
+    }
+
+    struct TurnStats {
+        size_t unchanged = 0; // frames that kept the whole fan
+        size_t partial = 0; // frames that only traced the rays that came into view
+        size_t full = 0;
+        size_t traced = 0;
+        float maxError = 0.0f; // kept rays against freshly computed directions
+    };
+
+    // fov 60 and rays_num 100 from config.yaml give 50 rays per view, 1.2 degrees apart. Keyboard turns are 3 degrees,
+    // sometimes back the other way, across 0 as well
+    TurnStats simulateTurns(int frames, bool snapped) {
+        const size_t rays = 50;
+        const float stepDegrees = 60.0f / rays;
+        raycast::RayFan fan;
+        fan.resize(rays);
+        raycast::RayFan fresh;
+        fresh.resize(rays);
+
+        std::mt19937 rng(3);
+        TurnStats stats;
+        float heading = 0.0f;
+        float cast = 0.0f;
+        bool valid = false;
+        for (int frame = 0; frame < frames; ++frame) {
+            if (frame % 4 == 0) heading += rng() % 3 == 0 ? -3.0f : 3.0f; // a key press every few frames
+            float next = snapped ? raycast::snapHeading(heading, stepDegrees) : heading;
+
+            long shift = 0;
+            bool keep = valid;
+            if (keep && snapped) keep = raycast::getLatticeShift(cast, next, stepDegrees, rays, shift);
+            if (keep && !snapped) { // the whole-step test the cache used before the lattice
+                float steps = std::remainder(next - cast, 360.0f) / stepDegrees;
+                keep = std::abs(steps - std::round(steps)) < 1e-3f && std::abs(std::round(steps)) < static_cast<float>(rays);
+                shift = static_cast<long>(std::round(steps));
+            }
+            valid = true;
+            cast = next;
+            if (keep && shift == 0) { ++stats.unchanged; continue; }
+
+            size_t begin = 0;
+            size_t end = rays;
+            if (keep) {
+                ++stats.partial;
+                size_t kept = rays - static_cast<size_t>(std::abs(shift));
+                size_t from = shift > 0 ? static_cast<size_t>(shift) : 0;
+                size_t to = shift > 0 ? 0 : static_cast<size_t>(-shift);
+                std::memmove(&fan.dirX[to], &fan.dirX[from], kept * sizeof(float));
+                std::memmove(&fan.dirY[to], &fan.dirY[from], kept * sizeof(float));
+                begin = shift > 0 ? kept : 0;
+                end = shift > 0 ? rays : to;
+
+                // a kept ray has to look exactly where the fresh fan's ray at its new index looks
+                raycast::computeDirections(fresh, next * 3.14159265f / 180.0f, stepDegrees * 3.14159265f / 180.0f);
+                for (size_t i = 0; i < rays; ++i) {
+                    if (i >= begin && i < end) continue;
+                    stats.maxError = std::max(stats.maxError, std::max(std::fabs(fan.dirX[i] - fresh.dirX[i]), std::fabs(fan.dirY[i] - fresh.dirY[i])));
+                }
+            } else {
+                ++stats.full;
+            }
+            stats.traced += end - begin;
+            raycast::computeDirections(fan, next * 3.14159265f / 180.0f, stepDegrees * 3.14159265f / 180.0f);
+        }
+        return stats;
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    std::vector<sf::Color> shades(2 * raycast::SHADE_LEVELS);
+    for (int i = 0; i < raycast::SHADE_LEVELS; ++i) {
+        sf::Uint8 level = static_cast<sf::Uint8>(255 - i);
+        shades[i] = sf::Color(level, level, level);
+        shades[raycast::SHADE_LEVELS + i] = sf::Color(level * 4 / 5, level * 4 / 5, level * 4 / 5);
+    }
+    raycast::WallProjection projection;
+    projection.centerY = 300.0f;
+    projection.shades[0] = shades.data();
+    projection.shades[1] = shades.data() + raycast::SHADE_LEVELS;
+
+    std::vector<raycast::KernelPath> paths { raycast::KernelPath::SCALAR };
+    if (raycast::detectKernelPath() >= raycast::KernelPath::SSE) paths.push_back(raycast::KernelPath::SSE);
+    if (raycast::detectKernelPath() >= raycast::KernelPath::AVX2) paths.push_back(raycast::KernelPath::AVX2);
+
+    std::printf("%d frames, detected %s\n", frames, raycast::getKernelPathName(raycast::detectKernelPath()));
+    std::printf("%8s %8s %12s %10s %12s\n", "rays", "path", "ns/ray", "speedup", "max error");
+
+    std::mt19937 rng(7);
+    for (size_t rays : { 500u, 1000u, 2000u, 4000u }) {
+        std::vector<float> distances(rays);
+        std::vector<int32_t> sides(rays);
+        std::uniform_real_distribution<float> distance(5.0f, 400.0f);
+        for (size_t i = 0; i < rays; ++i) {
+            distances[i] = rng() % 10 ? distance(rng) : 0.0f; // a tenth of the rays miss
+            sides[i] = rng() & 1;
+        }
+        projection.sliceWidth = 800.0f / rays;
+
+        std::vector<sf::Vertex> reference(4 * rays);
+        std::vector<sf::Vertex> out(4 * rays);
+        double scalarNs = 0.0;
+        for (raycast::KernelPath path : paths) {
+            bool isScalar = path == raycast::KernelPath::SCALAR;
+            PathTiming timing = timePath(path, rays, frames, distances, sides, projection, isScalar ? reference : out, isScalar ? nullptr : &reference);
+            if (isScalar) scalarNs = timing.nsPerRay;
+            std::printf("%8zu %8s %12.2f %9.2fx %12.5f\n", rays, raycast::getKernelPathName(path), timing.nsPerRay, scalarNs / timing.nsPerRay, timing.maxError);
+        }
+    }
+
+    std::printf("\n%d frames turning 3 degrees a press, 50 rays 1.2 degrees apart\n", frames);
+    std::printf("%10s %10s %10s %10s %14s %12s\n", "heading", "unchanged", "partial", "full", "traced/frame", "max error");
+    for (bool snapped : { false, true }) {
+        TurnStats stats = simulateTurns(frames, snapped);
+        std::printf("%10s %10zu %10zu %10zu %14.2f %12.2e\n", snapped ? "lattice" : "raw", stats.unchanged, stats.partial, stats.full,
+                    static_cast<double>(stats.traced) / frames, stats.maxError);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+//  searchBench.cpp
+//
+//  Lazy SMP scaling: time to a fixed depth and nodes per second for 1..N search threads.
+//  usage: search_bench [max threads] [depth] [tt size mb]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ai.hpp"
+
+namespace {
+    // a few deterministic positions: the opening plus what a shallow search reaches after some moves
+    std::vector<rules::BoardState> makePositions() {
+        std::vector<rules::BoardState> positions;
+        rules::BoardState board;
+        ai::AlphaBetaSearch opener(1, 1);
+        ai::SearchLimits limits;
+        limits.maxDepth = 2;
+        limits.timeBudget = std::chrono::milliseconds(10000);
+
+        for (int ply = 0; ply < 24 && !board.isGameOver(); ++ply) {
+            if (ply % 6 == 0) positions.push_back(board);
+            ai::SearchResult result = opener.search(board, limits);
+            if (!result.hasMove) break;
+            board.makeMove(result.bestMove);
+        }
+        return positions;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    int depth = argc > 2 ? std::atoi(argv[2]) : 7;
+    size_t ttSizeMb = argc > 3 ? std::atoi(argv[3]) : 64;
+
+    std::vector<rules::BoardState> positions = makePositions();
+    ai::SearchLimits limits;
+    limits.maxDepth = depth;
+    limits.timeBudget = std::chrono::milliseconds(600000); // depth bound only
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int count = 1; count < maxThreads; count *= 2) threadCounts.push_back(count);
+    threadCounts.push_back(maxThreads);
+
+    std::printf("%zu positions, depth %d, %zu MB table\n", positions.size(), depth, ttSizeMb);
+    std::printf("%8s %14s %12s %14s %10s %10s\n", "threads", "nodes", "ms to depth", "nps", "speedup", "tt hits");
+
+    ai::AlphaBetaSearch search(ttSizeMb, 1);
+    double baseMs = 0.0;
+    for (unsigned int threads : threadCounts) {
+        search.setThreadCount(threads);
+        uint64_t nodes = 0, probes = 0, hits = 0;
+        double totalMs = 0.0;
+        for (const rules::BoardState& position : positions) {
+            search.getTable().clear(); // every run starts cold
+            ai::SearchResult result = search.search(position, limits);
+            nodes += result.nodes;
+            probes += result.ttProbes;
+            hits += result.ttHits;
+            totalMs += result.elapsedMs;
+        }
+        if (baseMs == 0.0) baseMs = totalMs;
+        std::printf("%8u %14llu %12.1f %14.0f %9.2fx %9.1f%%\n", threads, static_cast<unsigned long long>(nodes), totalMs,
+                    nodes / (totalMs / 1000.0), baseMs / totalMs, probes ? 100.0 * hits / probes : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,668 @@
+#include "ai.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace ai {
+    namespace {
+        constexpr int INFINITE_SCORE = WIN_SCORE + 1;
+        constexpr int PATH_WEIGHT = 100; // one step of path difference
+        constexpr int WALL_WEIGHT = 10; // a wall in hand is worth a little, not a step
+        constexpr int TEMPO_BONUS = 50; // the side to move is half a step ahead
+
+        bool keepsBothPaths(const rules::BoardState& board) {
+            return board.hasPathToGoal(rules::Side::BLUE) && board.hasPathToGoal(rules::Side::RED);
+        }
+
+        // win scores count plies from the root, the table stores them relative to the node instead
+        int scoreToTable(int score, int ply) {
+            if (score >= WIN_SCORE - MAX_PLY) return score + ply;
+            if (score <= -(WIN_SCORE - MAX_PLY)) return score - ply;
+            return score;
+        }
+
+        int scoreFromTable(int score, int ply) {
+            if (score >= WIN_SCORE - MAX_PLY) return score - ply;
+            if (score <= -(WIN_SCORE - MAX_PLY)) return score + ply;
+            return score;
+        }
+
+        // data word: score 32 | depth 8 | bound 2 | has move 1 | move type 2 | move index 8 | generation 8
+        uint64_t packEntry(int score, int depth, Bound bound, const rules::Move* move, uint8_t generation) {
+            uint64_t data = static_cast<uint32_t>(score);
+            data |= static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32;
+            data |= static_cast<uint64_t>(bound) << 40;
+            if (move) {
+                data |= 1ULL << 42;
+                data |= static_cast<uint64_t>(move->type) << 43;
+                data |= static_cast<uint64_t>(move->index) << 45;
+            }
+            data |= static_cast<uint64_t>(generation) << 53;
+            return data;
+        }
+
+        TTEntry unpackEntry(uint64_t data) {
+            TTEntry entry;
+            entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+            entry.depth = static_cast<uint8_t>(data >> 32);
+            entry.bound = static_cast<Bound>((data >> 40) & 3);
+            entry.hasMove = (data >> 42) & 1;
+            entry.move = rules::Move{ static_cast<rules::MoveType>((data >> 43) & 3), static_cast<uint8_t>(data >> 45) };
+            return entry;
+        }
+
+        uint8_t entryGeneration(uint64_t data) { return static_cast<uint8_t>(data >> 53); }
+    }
+
+    TranspositionTable::TranspositionTable(size_t sizeMb) { resize(sizeMb); }
+
+    void TranspositionTable::resize(size_t sizeMb) {
+        size_t wanted = std::max<size_t>(1, sizeMb * 1024 * 1024 / sizeof(Bucket));
+        bucketCount = 1;
+        while (bucketCount * 2 <= wanted) bucketCount *= 2; // power of two so the index is a mask
+        buckets = std::make_unique<Bucket[]>(bucketCount);
+    }
+
+    void TranspositionTable::clear() {
+        for (size_t i = 0; i < bucketCount; ++i) {
+            for (Entry& entry : buckets[i].entries) {
+                entry.check.store(0, std::memory_order_relaxed);
+                entry.data.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TranspositionTable::probe(uint64_t hash, TTEntry& entry) const {
+        const Bucket& bucket = buckets[hash & (bucketCount - 1)];
+        for (const Entry& slot : bucket.entries) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) != hash || data == 0) continue;
+            entry = unpackEntry(data);
+            return true;
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(uint64_t hash, int depth, int score, Bound bound, const rules::Move* move) {
+        Bucket& bucket = buckets[hash & (bucketCount - 1)];
+        uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+
+        Entry* victim = nullptr;
+        int victimWorth = std::numeric_limits<int>::max();
+        for (Entry& slot : bucket.entries) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == hash) {
+                // same position: keep a clearly deeper result from this search, otherwise refresh it
+                TTEntry old = unpackEntry(data);
+                if (bound != Bound::EXACT && old.depth > depth + 2 && entryGeneration(data) == currentGeneration) return;
+                if (!move && old.hasMove) move = &old.move;
+                victim = &slot;
+                break;
+            }
+
+            // otherwise evict the shallowest, oldest entry. empty slots are worth nothing
+            int age = static_cast<uint8_t>(currentGeneration - entryGeneration(data));
+            int worth = data == 0 ? std::numeric_limits<int>::min() : unpackEntry(data).depth - 4 * age;
+            if (worth < victimWorth) {
+                victimWorth = worth;
+                victim = &slot;
+            }
+        }
+
+        uint64_t data = packEntry(score, depth, bound, move, currentGeneration);
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(hash ^ data, std::memory_order_relaxed);
+    }
+
+    double TranspositionTable::getOccupancy() const {
+        size_t sampled = std::min<size_t>(bucketCount, 1024);
+        size_t current = 0;
+        uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < sampled; ++i) {
+            for (const Entry& slot : buckets[i].entries) {
+                uint64_t data = slot.data.load(std::memory_order_relaxed);
+                if (data != 0 && entryGeneration(data) == currentGeneration) ++current;
+            }
+        }
+        return static_cast<double>(current) / (sampled * BUCKET_SIZE);
+    }
+
+    int evaluate(const rules::BoardState& board) {
+        rules::Side side = board.getSideToMove();
+        rules::Side other = rules::opponent(side);
+
+        int ownPath = board.shortestPathLength(side);
+        int otherPath = board.shortestPathLength(other);
+        return (otherPath - ownPath) * PATH_WEIGHT + (board.getWallsLeft(side) - board.getWallsLeft(other)) * WALL_WEIGHT + TEMPO_BONUS;
+    }
+
+    void generateSearchMoves(const rules::BoardState& board, std::vector<rules::Move>& moves) {
+        moves.clear();
+        rules::Side side = board.getSideToMove();
+        rules::Side other = rules::opponent(side);
+
+        // pawn moves heading for the goal column first, they are usually best
+        int fromCol = rules::cellCol(board.getPawn(side));
+        int goalCol = side == rules::Side::BLUE ? rules::BOARD_SIZE - 1 : 0;
+        rules::Bitboard pawnMoves = board.getPawnMoves(side);
+        size_t forwardCount = 0;
+        while (pawnMoves) {
+            int cell = rules::lowestCell(pawnMoves);
+            pawnMoves &= pawnMoves - 1;
+            moves.push_back(rules::Move{ rules::MoveType::PAWN, static_cast<uint8_t>(cell) });
+            if (std::abs(goalCol - rules::cellCol(cell)) < std::abs(goalCol - fromCol)) std::swap(moves[forwardCount++], moves.back());
+        }
+
+        if (board.getWallsLeft(side) <= 0) return;
+
+        // a wall off every shortest route of the opponent can't slow them down, so only these are worth searching
+        rules::Bitboard otherRoute = board.getShortestPathCells(other);
+        for (rules::MoveType orientation : { rules::MoveType::HORIZONTAL_WALL, rules::MoveType::VERTICAL_WALL }) {
+            uint64_t slots = board.getPlaceableWalls(orientation) & board.getWallsCutting(orientation, otherRoute);
+            while (slots) {
+                int slot = __builtin_ctzll(slots);
+                slots &= slots - 1;
+                moves.push_back(rules::Move{ orientation, static_cast<uint8_t>(slot) });
+            }
+        }
+    }
+
+    AlphaBetaSearch::AlphaBetaSearch(size_t ttSizeMb, unsigned int threadCount) : table(std::make_shared<TranspositionTable>(ttSizeMb)) {
+        setThreadCount(threadCount);
+    }
+
+    void AlphaBetaSearch::setThreadCount(unsigned int count) {
+        if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+        workers.clear();
+        for (unsigned int id = 0; id < count; ++id) {
+            workers.push_back(std::make_unique<Worker>());
+            workers.back()->id = id;
+        }
+    }
+
+    SearchResult AlphaBetaSearch::search(const rules::BoardState& position, const SearchLimits& limits) {
+        Clock::time_point start = Clock::now();
+        deadline = start + limits.timeBudget;
+        stopped.store(false, std::memory_order_relaxed);
+        table->newSearch();
+
+        SearchResult result;
+        if (position.isGameOver()) return result;
+
+        // fallback in case not even depth 1 finishes: first legal move
+        std::vector<rules::Move>& rootMoves = workers[0]->moveLists[0];
+        generateSearchMoves(position, rootMoves);
+        for (const rules::Move& move : rootMoves) {
+            if (position.isLegalMove(move)) {
+                result.bestMove = move;
+                result.hasMove = true;
+                break;
+            }
+        }
+        if (!result.hasMove) return result;
+
+        for (std::unique_ptr<Worker>& worker : workers) {
+            worker->board = position;
+            worker->rootBest = result.bestMove;
+            worker->nodes = worker->ttProbes = worker->ttHits = 0;
+            worker->completedDepth = 0;
+        }
+
+        // Lazy SMP: helpers run the same iterative deepening on their own board and only talk through the table.
+        // The main worker owns the clock and raises the stop flag when it is done
+        std::vector<std::thread> helpers;
+        for (size_t i = 1; i < workers.size(); ++i) {
+            helpers.emplace_back([this, &limits, start, i] { iterate(*workers[i], limits, start); });
+        }
+        iterate(*workers[0], limits, start);
+        stopped.store(true, std::memory_order_relaxed);
+        for (std::thread& helper : helpers) helper.join();
+
+        // deepest finished iteration wins, the main worker on ties
+        const Worker* best = workers[0].get();
+        for (const std::unique_ptr<Worker>& worker : workers) {
+            if (worker->completedDepth > best->completedDepth) best = worker.get();
+            result.nodes += worker->nodes;
+            result.ttProbes += worker->ttProbes;
+            result.ttHits += worker->ttHits;
+        }
+        if (best->completedDepth > 0) {
+            result.bestMove = best->rootBest;
+            result.score = best->score;
+            result.depth = best->completedDepth;
+        }
+        result.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return result;
+    }
+
+    void AlphaBetaSearch::iterate(Worker& worker, const SearchLimits& limits, Clock::time_point start) {
+        // helpers skip some depths in a per-thread pattern so they spread over several iterations at once
+        static constexpr std::array<int, 20> skipSize { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+        static constexpr std::array<int, 20> skipPhase { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+        for (int depth = 1; depth <= std::min(limits.maxDepth, MAX_PLY - 1); ++depth) {
+            if (worker.id > 0) {
+                size_t pattern = (worker.id - 1) % skipSize.size();
+                if (((depth + skipPhase[pattern]) / skipSize[pattern]) % 2 != 0) continue;
+            }
+
+            worker.iterationBest = worker.rootBest;
+            int score = negamax(worker, depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+            if (stopped.load(std::memory_order_relaxed)) break;
+
+            worker.rootBest = worker.iterationBest;
+            worker.score = score;
+            worker.completedDepth = depth;
+
+            if (std::abs(score) >= WIN_SCORE - MAX_PLY) break; // forced result, deeper won't change it
+            if (worker.id == 0 && Clock::now() - start > limits.timeBudget / 2) break; // next iteration would not finish in time
+        }
+    }
+
+    bool AlphaBetaSearch::outOfTime(Worker& worker) {
+        if ((worker.nodes & 1023) == 0 && Clock::now() >= deadline) stopped.store(true, std::memory_order_relaxed);
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    int AlphaBetaSearch::negamax(Worker& worker, int depth, int ply, int alpha, int beta) {
+        ++worker.nodes;
+        if (outOfTime(worker)) return 0;
+
+        rules::BoardState& board = worker.board;
+        rules::Side side = board.getSideToMove();
+        if (board.hasReachedGoal(rules::opponent(side))) return -(WIN_SCORE - ply); // opponent just arrived
+        if (depth == 0 || ply >= MAX_PLY - 1) return evaluate(board);
+
+        int alphaOriginal = alpha;
+        TTEntry entry;
+        ++worker.ttProbes;
+        bool found = table->probe(board.getHash(), entry);
+        if (found) {
+            ++worker.ttHits;
+            if (ply > 0 && entry.depth >= depth) {
+                int stored = scoreFromTable(entry.score, ply);
+                if (entry.bound == Bound::EXACT) return stored;
+                if (entry.bound == Bound::LOWER && stored >= beta) return stored;
+                if (entry.bound == Bound::UPPER && stored <= alpha) return stored;
+            }
+        }
+
+        // previous iteration's choice at the root, the table's best move everywhere else
+        std::vector<rules::Move>& moves = worker.moveLists[ply];
+        generateSearchMoves(board, moves);
+        if (ply == 0 || (found && entry.hasMove)) {
+            auto first = std::find(moves.begin(), moves.end(), ply == 0 ? worker.rootBest : entry.move);
+            if (first != moves.end()) std::rotate(moves.begin(), first, first + 1);
+        }
+
+        int best = -INFINITE_SCORE;
+        rules::Move bestMove {};
+        for (size_t i = 0; i < moves.size(); ++i) {
+            rules::Move move = moves[i]; // copy, deeper plies reuse their own buffers but be safe on reallocation
+            rules::MoveUndo undo = board.makeMove(move);
+            if (move.isWall() && !keepsBothPaths(board)) { // walls are generated pseudo-legally, checked only when searched
+                board.unmakeMove(undo);
+                continue;
+            }
+
+            int score = -negamax(worker, depth - 1, ply + 1, -beta, -alpha);
+            board.unmakeMove(undo);
+            if (stopped.load(std::memory_order_relaxed)) return 0;
+
+            if (score > best) {
+                best = score;
+                bestMove = move;
+                if (ply == 0) worker.iterationBest = move;
+            }
+            alpha = std::max(alpha, score);
+            if (alpha >= beta) break;
+        }
+
+        if (best == -INFINITE_SCORE) return evaluate(board); // boxed in by the other pawn, nothing to play
+
+        Bound bound = best <= alphaOriginal ? Bound::UPPER : (best >= beta ? Bound::LOWER : Bound::EXACT);
+        table->store(board.getHash(), depth, scoreToTable(best, ply), bound, &bestMove);
+        return best;
+    }
+
+    namespace {
+        constexpr int32_t VIRTUAL_LOSS = 3; // visits a thread books on its way down, paid back with the real result
+        constexpr int ROLLOUT_LIMIT = 200; // plies, then the shorter path wins
+        constexpr uint64_t WALL_CHANCE = 15; // percent of rollout turns that try a wall first
+
+        uint64_t nextRandom(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // both slots whose wall would block stepping from cell in direction, -1 where a slot falls off the board
+        std::array<int, 2> slotsBlocking(int cell, rules::Direction direction, rules::MoveType& orientation) {
+            if (direction == rules::NORTH || direction == rules::WEST) { // same edge seen from the neighbour
+                cell = rules::neighbourCell(cell, direction);
+                direction = direction == rules::NORTH ? rules::SOUTH : rules::EAST;
+            }
+            int row = rules::cellRow(cell);
+            int col = rules::cellCol(cell);
+            if (direction == rules::SOUTH) {
+                orientation = rules::MoveType::HORIZONTAL_WALL;
+                if (row >= rules::WALL_SIZE) return { -1, -1 };
+                return { col < rules::WALL_SIZE ? rules::slotIndex(row, col) : -1, col > 0 ? rules::slotIndex(row, col - 1) : -1 };
+            }
+            orientation = rules::MoveType::VERTICAL_WALL;
+            if (col >= rules::WALL_SIZE) return { -1, -1 };
+            return { row < rules::WALL_SIZE ? rules::slotIndex(row, col) : -1, row > 0 ? rules::slotIndex(row - 1, col) : -1 };
+        }
+    }
+
+    uint32_t MonteCarloSearch::Arena::allocate(uint32_t count) {
+        uint32_t first = used.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > capacity) return NO_NODE; // stays over capacity, later calls fail too
+        return first;
+    }
+
+    MonteCarloSearch::MonteCarloSearch(const MctsSettings& settings) : settings(settings) {
+        for (Arena& arena : arenas) {
+            arena.capacity = std::max<size_t>(settings.nodeLimit, 1);
+            arena.nodes = std::make_unique<Node[]>(arena.capacity);
+        }
+        setThreadCount(settings.threadCount);
+    }
+
+    void MonteCarloSearch::setThreadCount(unsigned int count) {
+        settings.threadCount = count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : count;
+    }
+
+    SearchResult MonteCarloSearch::search(const rules::BoardState& position, const SearchLimits& limits) {
+        Clock::time_point start = Clock::now();
+        SearchResult result;
+        if (position.isGameOver()) return result;
+
+        if (!reuseTree(position)) resetTree(position);
+        playouts.store(0, std::memory_order_relaxed);
+        deepest.store(0, std::memory_order_relaxed);
+
+        Clock::time_point deadline = start + limits.timeBudget;
+        std::vector<std::thread> helpers;
+        for (unsigned int id = 1; id < settings.threadCount; ++id) {
+            helpers.emplace_back([this, id, deadline, &limits] { runWorker(id, treeBoard, deadline, limits.maxPlayouts); });
+        }
+        runWorker(0, treeBoard, deadline, limits.maxPlayouts);
+        for (std::thread& helper : helpers) helper.join();
+
+        // most visited root child, wins break ties
+        const Node& root = tree().nodes[0];
+        if (root.state.load(std::memory_order_acquire) == EXPANDED) {
+            const Node* best = nullptr;
+            for (uint32_t i = 0; i < root.childCount; ++i) {
+                const Node& child = tree().nodes[root.firstChild + i];
+                if (!best || child.visits > best->visits || (child.visits == best->visits && child.wins > best->wins)) best = &child;
+            }
+            if (best) {
+                result.bestMove = best->move;
+                result.hasMove = true;
+                double winRate = best->visits > 0 ? static_cast<double>(best->wins) / best->visits : 0.5;
+                result.score = static_cast<int>((winRate * 2.0 - 1.0) * 1000.0); // win rate mapped to -1000..1000
+            }
+        }
+
+        result.depth = deepest.load(std::memory_order_relaxed);
+        result.nodes = std::min<size_t>(tree().used.load(std::memory_order_relaxed), tree().capacity);
+        result.playouts = playouts.load(std::memory_order_relaxed);
+        if (limits.maxPlayouts) result.playouts = std::min(result.playouts, limits.maxPlayouts); // workers over-book the last few
+        result.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return result;
+    }
+
+    void MonteCarloSearch::runWorker(unsigned int id, const rules::BoardState& root, Clock::time_point deadline, uint64_t maxPlayouts) {
+        uint64_t seed = 0x5EED0000ULL + id;
+        std::vector<PathStep> path;
+        std::vector<rules::Move> moves;
+        Node* nodes = tree().nodes.get();
+
+        while (Clock::now() < deadline) {
+            if (maxPlayouts && playouts.fetch_add(1, std::memory_order_relaxed) >= maxPlayouts) break;
+
+            // selection, booking virtual loss on the way down
+            rules::BoardState board = root;
+            path.clear();
+            path.push_back({ 0, rules::opponent(root.getSideToMove()) });
+            nodes[0].visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+
+            uint32_t index = 0;
+            while (nodes[index].state.load(std::memory_order_acquire) == EXPANDED && nodes[index].childCount > 0) {
+                index = selectChild(nodes[index]);
+                path.push_back({ index, board.getSideToMove() });
+                nodes[index].visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+                board.makeMove(nodes[index].move);
+            }
+
+            // expansion, whoever gets the node first builds its children, the others just roll out from it
+            Node& leaf = nodes[index];
+            rules::Side winner;
+            if (board.hasReachedGoal(path.back().mover)) {
+                leaf.state.store(TERMINAL, std::memory_order_relaxed);
+                winner = path.back().mover;
+            } else {
+                uint8_t expected = UNEXPANDED;
+                bool roomLeft = tree().used.load(std::memory_order_relaxed) < tree().capacity;
+                if (roomLeft && leaf.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acq_rel)) expand(leaf, board, moves);
+                winner = rollout(board, seed);
+            }
+
+            // backpropagation, swap the virtual losses for one real visit
+            for (const PathStep& step : path) {
+                nodes[step.node].visits.fetch_add(1 - VIRTUAL_LOSS, std::memory_order_relaxed);
+                if (step.mover == winner) nodes[step.node].wins.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!maxPlayouts) playouts.fetch_add(1, std::memory_order_relaxed);
+
+            int depth = static_cast<int>(path.size()) - 1;
+            int seen = deepest.load(std::memory_order_relaxed);
+            while (depth > seen && !deepest.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+        }
+    }
+
+    uint32_t MonteCarloSearch::selectChild(const Node& node) const {
+        const Node* nodes = arenas[current].nodes.get();
+        double parentVisits = std::max(1, node.visits.load(std::memory_order_relaxed));
+        double logParent = std::log(parentVisits);
+        double sqrtParent = std::sqrt(parentVisits);
+
+        uint32_t best = node.firstChild;
+        double bestValue = -std::numeric_limits<double>::infinity();
+        for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+            int32_t visits = nodes[i].visits.load(std::memory_order_relaxed);
+            double winRate = visits > 0 ? static_cast<double>(nodes[i].wins.load(std::memory_order_relaxed)) / visits : 0.5;
+
+            double value;
+            if (settings.policy == SelectionPolicy::UCT) {
+                if (visits == 0) return i; // every child once before any exploitation
+                value = winRate + settings.exploration * std::sqrt(logParent / visits);
+            } else {
+                value = winRate + settings.exploration * nodes[i].prior * sqrtParent / (1 + visits);
+            }
+
+            if (value > bestValue) {
+                bestValue = value;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    void MonteCarloSearch::expand(Node& node, const rules::BoardState& board, std::vector<rules::Move>& moves) {
+        rules::Side side = board.getSideToMove();
+        rules::Side other = rules::opponent(side);
+        int ownPath = board.shortestPathLength(side);
+        int otherPath = board.shortestPathLength(other);
+
+        // legal children and a path-race heuristic for their priors
+        generateSearchMoves(board, moves);
+        std::vector<float> gains;
+        size_t kept = 0;
+        for (const rules::Move& move : moves) {
+            rules::BoardState next = board;
+            next.makeMove(move);
+            int ownAfter = next.shortestPathLength(side);
+            int otherAfter = next.shortestPathLength(other);
+            if (ownAfter < 0 || otherAfter < 0) continue; // wall seals someone in
+
+            moves[kept++] = move;
+            float gain = static_cast<float>((ownPath - ownAfter) + (otherAfter - otherPath));
+            if (move.isWall()) gain -= 0.5f; // spending a wall is not free
+            gains.push_back(gain);
+        }
+        moves.resize(kept);
+
+        uint32_t first = kept ? arenas[current].allocate(static_cast<uint32_t>(kept)) : NO_NODE;
+        if (kept && first == NO_NODE) { // arena full, leave it as a leaf someone can retry
+            node.state.store(UNEXPANDED, std::memory_order_release);
+            return;
+        }
+
+        float total = 0.0f;
+        for (float& gain : gains) total += (gain = std::exp(gain));
+        Node* nodes = arenas[current].nodes.get();
+        for (size_t i = 0; i < kept; ++i) {
+            Node& child = nodes[first + i];
+            child.move = moves[i];
+            child.prior = gains[i] / total;
+            child.firstChild = NO_NODE;
+            child.childCount = 0;
+            child.visits.store(0, std::memory_order_relaxed);
+            child.wins.store(0, std::memory_order_relaxed);
+            child.state.store(UNEXPANDED, std::memory_order_relaxed);
+        }
+
+        node.firstChild = first;
+        node.childCount = static_cast<uint16_t>(kept);
+        node.state.store(EXPANDED, std::memory_order_release); // publishes the children
+    }
+
+    rules::Side MonteCarloSearch::rollout(rules::BoardState board, uint64_t& seed) const {
+        rules::PathOracle oracle(board);
+
+        for (int ply = 0; ply < ROLLOUT_LIMIT; ++ply) {
+            rules::Side side = board.getSideToMove();
+            rules::Side other = rules::opponent(side);
+            if (board.hasReachedGoal(other)) return other;
+
+            // now and then drop a wall across the opponent's next step
+            if (board.getWallsLeft(side) > 0 && nextRandom(seed) % 100 < WALL_CHANCE) {
+                int cell = board.getPawn(other);
+                int distance = oracle.getDistance(other, cell);
+                for (int direction = rules::NORTH; direction <= rules::WEST; ++direction) {
+                    int next = rules::neighbourCell(cell, static_cast<rules::Direction>(direction));
+                    if (next < 0 || !board.canStep(cell, static_cast<rules::Direction>(direction)) || oracle.getDistance(other, next) >= distance) continue;
+
+                    rules::MoveType orientation;
+                    std::array<int, 2> slots = slotsBlocking(cell, static_cast<rules::Direction>(direction), orientation);
+                    int slot = slots[nextRandom(seed) & 1];
+                    if (slot < 0 || !board.isWallPlaceable(orientation, slot) || !oracle.keepsBothExits(board, orientation, slot)) break;
+
+                    board.makeMove({ orientation, static_cast<uint8_t>(slot) });
+                    oracle.onWallPlaced(board, orientation, slot);
+                    break;
+                }
+                if (board.getSideToMove() != side) continue;
+            }
+
+            // greedy step, random among equally short ones
+            rules::Bitboard steps = board.getPawnMoves(side);
+            int bestCell = -1;
+            int bestDistance = rules::PathOracle::UNREACHABLE + 1;
+            uint64_t ties = 0;
+            while (steps) {
+                int cell = rules::lowestCell(steps);
+                steps &= steps - 1;
+                int distance = oracle.getDistance(side, cell);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestCell = cell;
+                    ties = 1;
+                } else if (distance == bestDistance && nextRandom(seed) % ++ties == 0) {
+                    bestCell = cell;
+                }
+            }
+            if (bestCell < 0) board.setSideToMove(other); // boxed in, pass
+            else board.makeMove({ rules::MoveType::PAWN, static_cast<uint8_t>(bestCell) });
+        }
+
+        // out of plies: the shorter race wins, the side to move takes ties
+        rules::Side side = board.getSideToMove();
+        rules::Side other = rules::opponent(side);
+        return oracle.getDistance(side, board.getPawn(side)) <= oracle.getDistance(other, board.getPawn(other)) ? side : other;
+    }
+
+    bool MonteCarloSearch::reuseTree(const rules::BoardState& position) {
+        if (!hasTree) return false;
+        const Node* nodes = tree().nodes.get();
+        if (nodes[0].state.load(std::memory_order_acquire) != EXPANDED) return false;
+
+        // the position is usually our move plus their reply below the old root
+        uint32_t match = NO_NODE;
+        if (treeBoard.getHash() == position.getHash()) match = 0;
+        for (uint32_t i = nodes[0].firstChild; match == NO_NODE && i < nodes[0].firstChild + nodes[0].childCount; ++i) {
+            rules::BoardState child = treeBoard;
+            child.makeMove(nodes[i].move);
+            if (child.getHash() == position.getHash()) {
+                match = i;
+                break;
+            }
+            if (nodes[i].state.load(std::memory_order_acquire) != EXPANDED) continue;
+            for (uint32_t j = nodes[i].firstChild; j < nodes[i].firstChild + nodes[i].childCount; ++j) {
+                rules::BoardState grandchild = child;
+                grandchild.makeMove(nodes[j].move);
+                if (grandchild.getHash() == position.getHash()) {
+                    match = j;
+                    break;
+                }
+            }
+        }
+        if (match == NO_NODE) return false;
+
+        // breadth-first copy into the spare arena keeps every child list contiguous
+        Arena& target = arenas[1 - current];
+        Node* copies = target.nodes.get();
+        target.used.store(1, std::memory_order_relaxed);
+        std::vector<std::pair<uint32_t, uint32_t>> queue { { match, 0 } };
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const Node& from = nodes[queue[head].first];
+            Node& to = copies[queue[head].second];
+            to.move = from.move;
+            to.prior = from.prior;
+            to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.wins.store(from.wins.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.firstChild = NO_NODE;
+            to.childCount = 0;
+
+            uint8_t state = from.state.load(std::memory_order_relaxed);
+            if (state == EXPANDED && from.childCount > 0) {
+                to.firstChild = target.allocate(from.childCount);
+                to.childCount = from.childCount;
+                for (uint32_t i = 0; i < from.childCount; ++i) queue.push_back({ from.firstChild + i, to.firstChild + i });
+            }
+            to.state.store(state == EXPANDING ? static_cast<uint8_t>(UNEXPANDED) : state, std::memory_order_relaxed);
+        }
+
+        current = 1 - current;
+        treeBoard = position;
+        return true;
+    }
+
+    void MonteCarloSearch::resetTree(const rules::BoardState& position) {
+        Node& root = tree().nodes[0];
+        root.firstChild = NO_NODE;
+        root.childCount = 0;
+        root.visits.store(0, std::memory_order_relaxed);
+        root.wins.store(0, std::memory_order_relaxed);
+        root.state.store(UNEXPANDED, std::memory_order_relaxed);
+        tree().used.store(1, std::memory_order_relaxed);
+        treeBoard = position;
+        hasTree = true;
+    }
+}
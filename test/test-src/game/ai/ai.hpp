@@ -0,0 +1,200 @@
+//
+//  ai.hpp
+//
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../rules/rules.hpp"
+
+// Computer players. Everything works on rules::BoardState only, so the scene, a headless arena or a benchmark can drive them.
+namespace ai {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int WIN_SCORE = 100000; // mate-style score, shrunk by ply so quicker wins rank higher
+    constexpr int MAX_PLY = 64;
+
+    struct SearchLimits {
+        std::chrono::milliseconds timeBudget { 250 };
+        int maxDepth = 8;
+        uint64_t maxPlayouts = 0; // MCTS only, 0 runs until the time budget is spent
+    };
+
+    struct SearchResult {
+        rules::Move bestMove {};
+        bool hasMove = false;
+        int score = 0; // from the side to move's point of view
+        int depth = 0; // deepest fully searched iteration
+        uint64_t nodes = 0;
+        double elapsedMs = 0.0;
+        uint64_t ttProbes = 0;
+        uint64_t ttHits = 0;
+        uint64_t playouts = 0; // MCTS only
+
+        double getTTHitRate() const { return ttProbes ? static_cast<double>(ttHits) / ttProbes : 0.0; }
+        double getPlayoutsPerSecond() const { return elapsedMs > 0.0 ? playouts / (elapsedMs / 1000.0) : 0.0; }
+    };
+
+    enum class Bound : uint8_t { NONE, EXACT, LOWER, UPPER };
+
+    struct TTEntry {
+        int score = 0;
+        int depth = 0;
+        Bound bound = Bound::NONE;
+        bool hasMove = false;
+        rules::Move move {};
+    };
+
+    // Fixed-size transposition table, 4 entries per 64 byte bucket. Lock-free: each entry is two atomic words and the
+    // first one stores hash ^ data, so a torn write from another thread just reads back as a miss.
+    class TranspositionTable {
+    public:
+        static constexpr size_t BUCKET_SIZE = 4;
+
+        explicit TranspositionTable(size_t sizeMb = 64);
+        void resize(size_t sizeMb); // rounds down to a power of two bucket count, drops every entry
+        void clear();
+        void newSearch() { generation.fetch_add(1, std::memory_order_relaxed); } // ages older entries for replacement
+
+        bool probe(uint64_t hash, TTEntry& entry) const;
+        void store(uint64_t hash, int depth, int score, Bound bound, const rules::Move* move);
+
+        size_t getEntryCount() const { return bucketCount * BUCKET_SIZE; }
+        size_t getSizeBytes() const { return bucketCount * sizeof(Bucket); }
+        double getOccupancy() const; // share of entries written during the current search, sampled
+
+    private:
+        struct Entry {
+            std::atomic<uint64_t> check { 0 }; // hash ^ data
+            std::atomic<uint64_t> data { 0 };
+        };
+        struct alignas(64) Bucket {
+            std::array<Entry, BUCKET_SIZE> entries;
+        };
+
+        std::unique_ptr<Bucket[]> buckets;
+        size_t bucketCount = 0;
+        std::atomic<uint8_t> generation { 0 };
+    };
+
+    // one turn's worth of thinking: give it a position, get a move back
+    class MoveSource {
+    public:
+        virtual ~MoveSource() = default;
+        virtual SearchResult search(const rules::BoardState& board, const SearchLimits& limits) = 0;
+        virtual std::string getName() const = 0;
+    };
+
+    int evaluate(const rules::BoardState& board); // shortest path race from the side to move's point of view
+    void generateSearchMoves(const rules::BoardState& board, std::vector<rules::Move>& moves); // pawn moves plus walls that cut the opponent's shortest routes
+
+    // Iterative deepening negamax with alpha-beta pruning over a transposition table. With more than one thread it
+    // runs Lazy SMP: every worker searches the whole tree and they share results only through the table.
+    class AlphaBetaSearch : public MoveSource {
+    public:
+        explicit AlphaBetaSearch(size_t ttSizeMb = 64, unsigned int threadCount = 1);
+        SearchResult search(const rules::BoardState& board, const SearchLimits& limits) override;
+        std::string getName() const override { return "alphabeta"; }
+
+        void setThreadCount(unsigned int count); // 0 takes one per hardware thread
+        unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+        TranspositionTable& getTable() { return *table; }
+
+    private:
+        struct alignas(64) Worker {
+            unsigned int id = 0; // 0 is the main worker, it runs on the caller's thread and owns the clock
+            rules::BoardState board;
+            std::array<std::vector<rules::Move>, MAX_PLY> moveLists; // one buffer per ply so the search doesn't allocate
+            rules::Move rootBest {}; // best move of the last finished iteration, searched first in the next one
+            rules::Move iterationBest {};
+            int completedDepth = 0;
+            int score = 0;
+            uint64_t nodes = 0;
+            uint64_t ttProbes = 0;
+            uint64_t ttHits = 0;
+        };
+
+        void iterate(Worker& worker, const SearchLimits& limits, Clock::time_point start);
+        int negamax(Worker& worker, int depth, int ply, int alpha, int beta);
+        bool outOfTime(Worker& worker);
+
+        std::shared_ptr<TranspositionTable> table;
+        std::vector<std::unique_ptr<Worker>> workers;
+        Clock::time_point deadline {};
+        std::atomic<bool> stopped { false }; // raised on timeout or when the main worker finishes, every worker unwinds
+    };
+
+    enum class SelectionPolicy : uint8_t { UCT, PUCT };
+
+    struct MctsSettings {
+        SelectionPolicy policy = SelectionPolicy::PUCT;
+        float exploration = 1.4f;
+        size_t nodeLimit = 1 << 20; // per arena, the search keeps two so a reused subtree can be compacted
+        unsigned int threadCount = 1; // 0 takes one per hardware thread
+    };
+
+    // Monte Carlo tree search. Nodes live in a flat arena and point at each other by index, children of a node are
+    // contiguous. Several threads walk the same tree, virtual loss steers them apart. Rollouts race both pawns down
+    // their shortest paths with the odd wall thrown in front of the opponent.
+    class MonteCarloSearch : public MoveSource {
+    public:
+        explicit MonteCarloSearch(const MctsSettings& settings = MctsSettings());
+        SearchResult search(const rules::BoardState& board, const SearchLimits& limits) override;
+        std::string getName() const override { return "mcts"; }
+
+        void setThreadCount(unsigned int count);
+        void clearTree() { hasTree = false; }
+
+    private:
+        static constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+        enum NodeState : uint8_t { UNEXPANDED, EXPANDING, EXPANDED, TERMINAL };
+
+        struct Node {
+            rules::Move move {}; // move that led here
+            float prior = 0.0f;
+            uint32_t firstChild = NO_NODE;
+            uint16_t childCount = 0;
+            std::atomic<uint8_t> state { UNEXPANDED };
+            std::atomic<int32_t> visits { 0 }; // includes virtual loss while a thread is below this node
+            std::atomic<int32_t> wins { 0 }; // for the side that played move
+        };
+
+        struct Arena {
+            std::unique_ptr<Node[]> nodes;
+            size_t capacity = 0;
+            std::atomic<uint32_t> used { 0 };
+
+            uint32_t allocate(uint32_t count); // NO_NODE once the arena is full
+        };
+
+        struct PathStep {
+            uint32_t node;
+            rules::Side mover; // side that played into node
+        };
+
+        void runWorker(unsigned int id, const rules::BoardState& root, Clock::time_point deadline, uint64_t maxPlayouts);
+        uint32_t selectChild(const Node& node) const;
+        void expand(Node& node, const rules::BoardState& board, std::vector<rules::Move>& moves);
+        rules::Side rollout(rules::BoardState board, uint64_t& seed) const;
+        bool reuseTree(const rules::BoardState& position); // moves the matching grandchild subtree into the spare arena
+        void resetTree(const rules::BoardState& position);
+
+        Arena& tree() { return arenas[current]; }
+
+        MctsSettings settings;
+        std::array<Arena, 2> arenas;
+        int current = 0;
+        bool hasTree = false;
+        rules::BoardState treeBoard; // position at the root of the tree
+        std::atomic<uint64_t> playouts { 0 };
+        std::atomic<int> deepest { 0 };
+    };
+}
@@ -0,0 +1,200 @@
+#include "bitmask.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITMASK_X86 1
+#define BITMASK_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace bitmask {
+    namespace {
+        bool detectWidePath() {
+#ifdef BITMASK_X86
+            static const bool supported = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return supported;
+#else
+            return false;
+#endif
+        }
+
+        std::atomic<bool> wideEnabled { detectWidePath() };
+
+        inline uint64_t loadWord(const uint8_t* row, size_t word) {
+            uint64_t value;
+            std::memcpy(&value, row + word * sizeof(uint64_t), sizeof(value));
+            return value;
+        }
+
+        // 64 pixels of a row starting at a bit offset, the part past the row comes from whatever follows it
+        inline uint64_t loadBits(const uint8_t* row, unsigned int bit) {
+            size_t word = bit / WORD_BITS;
+            unsigned int shift = bit % WORD_BITS;
+            uint64_t low = loadWord(row, word);
+            if (shift == 0) return low;
+            return (low >> shift) | (loadWord(row, word + 1) << (WORD_BITS - shift));
+        }
+
+        // one pair of rows, columns [0, columns) of the overlap starting at bit1 / bit2 of each row
+        bool rowsOverlap(const uint8_t* row1, unsigned int bit1, const uint8_t* row2, unsigned int bit2, unsigned int columns) {
+            unsigned int column = 0;
+            for (; column + WORD_BITS <= columns; column += WORD_BITS) {
+                if (loadBits(row1, bit1 + column) & loadBits(row2, bit2 + column)) return true;
+            }
+            if (column == columns) return false;
+            uint64_t tail = (uint64_t(1) << (columns - column)) - 1; // rest of the overlap, the bits past it belong to neither
+            return (loadBits(row1, bit1 + column) & loadBits(row2, bit2 + column) & tail) != 0;
+        }
+
+#ifdef BITMASK_X86
+        // four words of a row at once, the shift is the same for every word of a row. AVX2 shifts by 64 give zero,
+        // so an aligned row needs no special case
+        BITMASK_AVX2 inline __m256i loadBits4(const uint8_t* row, unsigned int bit) {
+            const uint8_t* base = row + (bit / WORD_BITS) * sizeof(uint64_t);
+            unsigned int shift = bit % WORD_BITS;
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + sizeof(uint64_t)));
+            return _mm256_or_si256(_mm256_srl_epi64(low, _mm_cvtsi32_si128(static_cast<int>(shift))),
+                                   _mm256_sll_epi64(high, _mm_cvtsi32_si128(static_cast<int>(WORD_BITS - shift))));
+        }
+
+        BITMASK_AVX2 bool rowsOverlapAVX2(const uint8_t* row1, unsigned int bit1, const uint8_t* row2, unsigned int bit2, unsigned int columns) {
+            unsigned int column = 0;
+            for (; column + 4 * WORD_BITS <= columns; column += 4 * WORD_BITS) {
+                __m256i both = _mm256_and_si256(loadBits4(row1, bit1 + column), loadBits4(row2, bit2 + column));
+                if (!_mm256_testz_si256(both, both)) return true;
+            }
+            return rowsOverlap(row1, bit1 + column, row2, bit2 + column, columns - column);
+        }
+#endif
+    }
+
+    std::shared_ptr<uint8_t[]> allocate(unsigned int width, unsigned int height) {
+        return std::shared_ptr<uint8_t[]>(new uint8_t[getByteSize(width, height)](), std::default_delete<uint8_t[]>());
+    }
+
+    bool overlaps(const uint8_t* mask1, int x1, int y1, unsigned int width1, unsigned int height1,
+                  const uint8_t* mask2, int x2, int y2, unsigned int width2, unsigned int height2) {
+        if (!mask1 || !mask2) return false;
+        int left = std::max(x1, x2);
+        int top = std::max(y1, y2);
+        int right = std::min(x1 + static_cast<int>(width1), x2 + static_cast<int>(width2));
+        int bottom = std::min(y1 + static_cast<int>(height1), y2 + static_cast<int>(height2));
+        if (left >= right || top >= bottom) return false;
+
+        const size_t rowBytes1 = getStride(width1) * sizeof(uint64_t);
+        const size_t rowBytes2 = getStride(width2) * sizeof(uint64_t);
+        const unsigned int bit1 = static_cast<unsigned int>(left - x1);
+        const unsigned int bit2 = static_cast<unsigned int>(left - x2);
+        const unsigned int columns = static_cast<unsigned int>(right - left);
+        const uint8_t* row1 = mask1 + static_cast<size_t>(top - y1) * rowBytes1;
+        const uint8_t* row2 = mask2 + static_cast<size_t>(top - y2) * rowBytes2;
+
+#ifdef BITMASK_X86
+        if (columns >= 4 * WORD_BITS && wideEnabled.load(std::memory_order_relaxed)) {
+            for (int y = top; y < bottom; ++y, row1 += rowBytes1, row2 += rowBytes2) {
+                if (rowsOverlapAVX2(row1, bit1, row2, bit2, columns)) return true;
+            }
+            return false;
+        }
+#endif
+        for (int y = top; y < bottom; ++y, row1 += rowBytes1, row2 += rowBytes2) {
+            if (rowsOverlap(row1, bit1, row2, bit2, columns)) return true;
+        }
+        return false;
+    }
+
+    bool hasWidePath() { return wideEnabled.load(std::memory_order_relaxed); }
+
+    void setWidePathEnabled(bool enabled) { wideEnabled.store(enabled && detectWidePath(), std::memory_order_relaxed); }
+
+    int getAngleIndex(float degrees) {
+        int index = static_cast<int>(std::lround(degrees * ANGLE_STEPS / 360.0f)) % ANGLE_STEPS;
+        return index < 0 ? index + ANGLE_STEPS : index;
+    }
+
+    RotatedMask rotate(const uint8_t* mask, unsigned int width, unsigned int height, int angleIndex) {
+        double radians = angleIndex * 2.0 * 3.14159265358979 / ANGLE_STEPS;
+        double cosAngle = std::cos(radians);
+        double sinAngle = std::sin(radians);
+
+        // bounding box of the turned corners, same parity as the source so both centres sit on the same spot
+        RotatedMask rotated;
+        rotated.width = static_cast<unsigned int>(std::ceil(std::fabs(width * cosAngle) + std::fabs(height * sinAngle) - 1e-6));
+        rotated.height = static_cast<unsigned int>(std::ceil(std::fabs(width * sinAngle) + std::fabs(height * cosAngle) - 1e-6));
+        rotated.width += (rotated.width - width) & 1u;
+        rotated.height += (rotated.height - height) & 1u;
+        rotated.offsetX = (static_cast<int>(width) - static_cast<int>(rotated.width)) / 2;
+        rotated.offsetY = (static_cast<int>(height) - static_cast<int>(rotated.height)) / 2;
+        rotated.mask = allocate(rotated.width, rotated.height);
+        if (!mask) return rotated;
+
+        // each target pixel centre turned back into the source
+        for (unsigned int y = 0; y < rotated.height; ++y) {
+            double dy = y + 0.5 - rotated.height * 0.5;
+            for (unsigned int x = 0; x < rotated.width; ++x) {
+                double dx = x + 0.5 - rotated.width * 0.5;
+                double sourceX = std::floor(cosAngle * dx + sinAngle * dy + width * 0.5);
+                double sourceY = std::floor(-sinAngle * dx + cosAngle * dy + height * 0.5);
+                if (sourceX < 0.0 || sourceY < 0.0 || sourceX >= width || sourceY >= height) continue;
+                if (getPixel(mask, width, static_cast<unsigned int>(sourceX), static_cast<unsigned int>(sourceY))) {
+                    setPixel(rotated.mask.get(), rotated.width, x, y);
+                }
+            }
+        }
+        return rotated;
+    }
+
+    RotatedMaskCache::RotatedMaskCache(size_t capacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+    std::shared_ptr<const RotatedMask> RotatedMaskCache::get(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height, float degrees) {
+        if (!mask) return nullptr;
+        std::lock_guard<std::mutex> guard(lock);
+        return find(mask, width, height, getAngleIndex(degrees));
+    }
+
+    void RotatedMaskCache::warm(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height) {
+        if (!mask) return;
+        std::lock_guard<std::mutex> guard(lock);
+        for (int angleIndex = 0; angleIndex < ANGLE_STEPS; ++angleIndex) find(mask, width, height, angleIndex);
+    }
+
+    size_t RotatedMaskCache::size() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return recent.size();
+    }
+
+    std::shared_ptr<const RotatedMask> RotatedMaskCache::find(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height, int angleIndex) {
+        Key key { mask.get(), width, height, angleIndex };
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            if (found->second->source.lock() == mask) { // same mask, not a new one at a freed one's address
+                recent.splice(recent.begin(), recent, found->second);
+                return found->second->rotated;
+            }
+            recent.erase(found->second);
+            entries.erase(found);
+        }
+
+        auto rotated = std::make_shared<const RotatedMask>(rotate(mask.get(), width, height, angleIndex));
+        recent.push_front(Entry { key, mask, rotated });
+        entries[key] = recent.begin();
+        if (recent.size() > capacity) {
+            entries.erase(recent.back().key);
+            recent.pop_back();
+        }
+        return rotated;
+    }
+
+    RotatedMaskCache& getRotatedMaskCache() {
+        static RotatedMaskCache cache;
+        return cache;
+    }
+}
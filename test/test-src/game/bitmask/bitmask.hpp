@@ -0,0 +1,97 @@
+//
+//  bitmask.hpp
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Packed collision masks, one bit per pixel. Every row starts on a 64-bit word, so an overlap test shifts and ANDs
+// whole words of two rows instead of looking at pixels. Plain bytes in and out so the sprites, tiles and globals keep
+// passing std::shared_ptr<sf::Uint8[]> around.
+namespace bitmask {
+    constexpr unsigned int WORD_BITS = 64;
+
+    // words per row, pixel x of row y is bit x % 64 of word y * stride + x / 64 (little endian words)
+    inline size_t getStride(unsigned int width) { return (width + WORD_BITS - 1) / WORD_BITS; }
+    // one spare zero word after the last row, so a row's last word can always be read together with the next
+    inline size_t getByteSize(unsigned int width, unsigned int height) { return (getStride(width) * height + 1) * sizeof(uint64_t); }
+
+    std::shared_ptr<uint8_t[]> allocate(unsigned int width, unsigned int height); // all clear
+
+    inline void setPixel(uint8_t* mask, unsigned int width, unsigned int x, unsigned int y) {
+        mask[y * getStride(width) * sizeof(uint64_t) + x / 8] |= static_cast<uint8_t>(1u << (x % 8));
+    }
+    inline bool getPixel(const uint8_t* mask, unsigned int width, unsigned int x, unsigned int y) {
+        return (mask[y * getStride(width) * sizeof(uint64_t) + x / 8] >> (x % 8)) & 1u;
+    }
+
+    // true if any pixel set in both masks lands on the same spot, positions are the masks' top left corners in pixels.
+    // Stops at the first word with a shared bit
+    bool overlaps(const uint8_t* mask1, int x1, int y1, unsigned int width1, unsigned int height1,
+                  const uint8_t* mask2, int x2, int y2, unsigned int width2, unsigned int height2);
+
+    bool hasWidePath(); // AVX2, taken for overlaps at least 256 pixels wide
+    void setWidePathEnabled(bool enabled); // benchmarks, ignored if the CPU has no AVX2
+
+    constexpr int ANGLE_STEPS = 120; // 3 degrees apart, the pawns turn 3 degrees at a time
+    int getAngleIndex(float degrees); // nearest step, any angle
+
+    struct RotatedMask {
+        std::shared_ptr<uint8_t[]> mask;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        int offsetX = 0; // top left, relative to the unrotated mask's top left
+        int offsetY = 0;
+    };
+    // turned clockwise about the mask's centre like sf::Transformable, big enough to hold every corner. Nearest pixel
+    RotatedMask rotate(const uint8_t* mask, unsigned int width, unsigned int height, int angleIndex);
+
+    // Rotated copies of masks, one per angle step, built the first time they're asked for and dropped least recently
+    // used first once there are more than capacity. Entries watch their source mask, a freed one is never matched
+    class RotatedMaskCache {
+    public:
+        explicit RotatedMaskCache(size_t capacity = 4 * ANGLE_STEPS);
+
+        std::shared_ptr<const RotatedMask> get(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height, float degrees);
+        void warm(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height); // every step now, for load time
+        size_t size() const;
+
+    private:
+        struct Key {
+            const uint8_t* source;
+            unsigned int width;
+            unsigned int height;
+            int angleIndex;
+            bool operator==(const Key& other) const {
+                return source == other.source && width == other.width && height == other.height && angleIndex == other.angleIndex;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return std::hash<const void*>()(key.source) ^ (static_cast<size_t>(key.angleIndex) * 0x9E3779B97F4A7C15ull) ^
+                       (static_cast<size_t>(key.width) << 16) ^ key.height;
+            }
+        };
+        struct Entry {
+            Key key;
+            std::weak_ptr<uint8_t[]> source;
+            std::shared_ptr<const RotatedMask> rotated;
+        };
+
+        std::shared_ptr<const RotatedMask> find(const std::shared_ptr<uint8_t[]>& mask, unsigned int width, unsigned int height, int angleIndex);
+
+        size_t capacity;
+        std::list<Entry> recent; // most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries;
+        mutable std::mutex lock;
+    };
+
+    RotatedMaskCache& getRotatedMaskCache(); // the one the collision code uses
+}
@@ -0,0 +1,36 @@
+#include "broadphase.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace physics {
+    const std::vector<SweepAndPrune::Pair>& SweepAndPrune::findPairs(const std::vector<sf::FloatRect>& boxes) {
+        pairs.clear();
+        if (order.size() != boxes.size()) { // different set of boxes, sort from scratch
+            order.resize(boxes.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [&boxes](uint32_t a, uint32_t b) { return boxes[a].left < boxes[b].left; });
+        } else { // same boxes a frame later, only a few swaps away from sorted
+            for (size_t i = 1; i < order.size(); ++i) {
+                uint32_t index = order[i];
+                float left = boxes[index].left;
+                size_t j = i;
+                for (; j > 0 && boxes[order[j - 1]].left > left; --j) order[j] = order[j - 1];
+                order[j] = index;
+            }
+        }
+
+        // strict overlaps like sf::Rect::intersects, boxes that only touch aren't a pair
+        for (size_t i = 0; i < order.size(); ++i) {
+            const sf::FloatRect& a = boxes[order[i]];
+            float right = a.left + a.width;
+            for (size_t j = i + 1; j < order.size() && boxes[order[j]].left < right; ++j) {
+                const sf::FloatRect& b = boxes[order[j]];
+                if (b.top < a.top + a.height && a.top < b.top + b.height) {
+                    pairs.emplace_back(std::min(order[i], order[j]), std::max(order[i], order[j]));
+                }
+            }
+        }
+        return pairs;
+    }
+}
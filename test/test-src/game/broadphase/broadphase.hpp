@@ -0,0 +1,28 @@
+//
+//  broadphase.hpp
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <SFML/Graphics/Rect.hpp>
+
+namespace physics {
+    // Sort and sweep. Boxes are kept sorted by their left edge between frames, so the re-sort is an insertion sort over
+    // an almost sorted list, then each box only meets the boxes that start before its right edge.
+    // Every overlapping pair comes out once per call, O(n log n + k) for k pairs
+    class SweepAndPrune {
+    public:
+        using Pair = std::pair<uint32_t, uint32_t>; // indices into the boxes, first < second
+
+        const std::vector<Pair>& findPairs(const std::vector<sf::FloatRect>& boxes);
+
+    private:
+        std::vector<uint32_t> order; // box indices by left edge, carried over to the next call
+        std::vector<Pair> pairs;
+    };
+}
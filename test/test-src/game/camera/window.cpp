@@ -1,8 +1,28 @@
 #include "window.hpp"
 
+#include <cmath>
+
 GameWindow::GameWindow(unsigned int screenWidth, unsigned int screenHeight, std::string gameTitle, unsigned int frameRate ) : window(sf::VideoMode(screenWidth, screenHeight), gameTitle,  sf::Style::Titlebar | sf::Style::Close) {
     window.setFramerateLimit(frameRate); 
 }
 
 GameView::GameView(sf::FloatRect viewRect) : view(sf::View(viewRect)){}
 
+bool CachedLayer::create(sf::FloatRect worldArea, float pixelsPerUnit) {
+    ready = false;
+    dirty = true;
+    unsigned int width = static_cast<unsigned int>(std::ceil(worldArea.width * pixelsPerUnit));
+    unsigned int height = static_cast<unsigned int>(std::ceil(worldArea.height * pixelsPerUnit));
+    if (width == 0 || height == 0 || !texture.create(width, height)) {
+        log_warning("Cached layer texture not created, drawing it live");
+        return false;
+    }
+
+    view = sf::View(sf::FloatRect(worldArea.left, worldArea.top, width / pixelsPerUnit, height / pixelsPerUnit)); // whole pixels, no resampling
+    sprite.setTexture(texture.getTexture(), true);
+    sprite.setPosition(worldArea.left, worldArea.top);
+    sprite.setScale(1.0f / pixelsPerUnit, 1.0f / pixelsPerUnit);
+    composite.blendMode = sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+    ready = true;
+    return true;
+}
@@ -34,3 +34,32 @@ private:
 
 };
 
+// Drawables that rarely change, baked into a texture and composited as one quad until invalidate() is called.
+// The texture covers a fixed world area, so a view can still pan across it like it would the live objects
+class CachedLayer {
+public:
+    bool create(sf::FloatRect worldArea, float pixelsPerUnit); // false leaves the layer drawing live
+    void invalidate() { dirty = true; }
+
+    // paint(sf::RenderTarget&) draws the layer's contents, it only runs when the layer was invalidated
+    template<typename Paint>
+    void draw(sf::RenderTarget& target, Paint&& paint) {
+        if (!ready) return paint(target);
+        if (dirty) {
+            texture.clear(sf::Color::Transparent);
+            texture.setView(view);
+            paint(static_cast<sf::RenderTarget&>(texture));
+            texture.display();
+            dirty = false;
+        }
+        target.draw(sprite, composite);
+    }
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    sf::View view;
+    sf::RenderStates composite; // colours in the texture are already multiplied by their alpha
+    bool ready = false;
+    bool dirty = true;
+};
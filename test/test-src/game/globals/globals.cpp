@@ -4,6 +4,7 @@
 //
 
 #include "globals.hpp"  
+#include "../bitmask/bitmask.hpp"
     
 namespace MetaComponents {
     sf::Clock clock;
@@ -244,12 +245,6 @@ namespace Constants {
             BACKGROUNDBIGFINAL_SCALE = {config["sprites"]["background_big_final"]["scale"]["x"].as<float>(),
                                 config["sprites"]["background_big_final"]["scale"]["y"].as<float>()};
 
-            BACKGROUNDBIGHALF_PATH = config["sprites"]["background_big_half"]["path"].as<std::string>();
-            BACKGROUNDBIGHALF_POSITION = {config["sprites"]["background_big_half"]["position"]["x"].as<float>(),
-                                    config["sprites"]["background_big_half"]["position"]["y"].as<float>()};
-            BACKGROUNDBIGHALF_SCALE = {config["sprites"]["background_big_half"]["scale"]["x"].as<float>(),
-                                config["sprites"]["background_big_half"]["scale"]["y"].as<float>()};
-
             BACKGROUND1_PATH = config["sprites"]["background_1"]["path"].as<std::string>();
             BACKGROUND2_PATH = config["sprites"]["background_2"]["path"].as<std::string>();
 
@@ -272,6 +267,18 @@ namespace Constants {
             WALLBLANK_INDEX = config["board"]["wall_blank_index"].as<size_t>(); 
             WALLTOP_INDEX = config["board"]["wall_top_index"].as<size_t>(); // both top and bottom
             TILE_THRESHOLD = config["board"]["tile_threshold"].as<float>(); // threshold for tile movement
+
+            // Load computer opponent settings
+            AI_ENABLED = config["ai"]["enabled"].as<bool>();
+            AI_PLAYS_RED = config["ai"]["plays_red"].as<bool>();
+            AI_ENGINE = config["ai"]["engine"].as<std::string>();
+            AI_TIME_BUDGET_MS = config["ai"]["time_budget_ms"].as<unsigned int>();
+            AI_MAX_DEPTH = config["ai"]["max_depth"].as<unsigned short>();
+            AI_TT_SIZE_MB = config["ai"]["tt_size_mb"].as<unsigned int>();
+            AI_THREADS = config["ai"]["threads"].as<unsigned int>();
+            AI_MCTS_POLICY = config["ai"]["mcts_policy"].as<std::string>();
+            AI_MCTS_EXPLORATION = config["ai"]["mcts_exploration"].as<float>();
+            AI_MCTS_NODE_LIMIT = config["ai"]["mcts_node_limit"].as<unsigned int>();
                                       
             // Load text settings
             TEXT_SIZE = config["text"]["size"].as<unsigned short>();
@@ -343,7 +350,6 @@ namespace Constants {
         if (!BACKGROUND1_TEXTURE->loadFromFile(BACKGROUND1_PATH)) log_warning("Failed to load background 1 texture");
         if (!BACKGROUND2_TEXTURE->loadFromFile(BACKGROUND2_PATH)) log_warning("Failed to load background 2 texture");
         if (!BACKGROUNDBIGFINAL_TEXTURE->loadFromFile(BACKGROUNDBIGFINAL_PATH)) log_warning("Failed to load background big final texture");
-        if (!BACKGROUNDBIGHALF_TEXTURE->loadFromFile(BACKGROUNDBIGHALF_PATH)) log_warning("Failed to load background big half texture");
         if (!STICK_TEXTURE->loadFromFile(STICK_PATH)) log_warning("Failed to load stick texture");
         if (!BOARDTILES_TEXTURE->loadFromFile(BOARDTILES_PATH)) log_warning("Failed to load board tiles texture");
 
@@ -364,6 +370,7 @@ namespace Constants {
         // make bitmasks for tiles 
         for (const auto& rect : SPRITE1_ANIMATIONRECTS ) {
             SPRITE1_BITMASK.emplace_back(createBitmask(SPRITE1_TEXTURE, rect, 0));
+            bitmask::getRotatedMaskCache().warm(SPRITE1_BITMASK.back(), rect.width, rect.height); // pawns turn, every angle now
         }
         SPRITE2_ANIMATIONRECTS.reserve(SPRITE2_INDEXMAX); 
         SPRITE2_ANIMATIONRECTS.emplace_back(sf::IntRect{0, 0, 31, 31});
@@ -371,6 +378,7 @@ namespace Constants {
         // make bitmasks for tiles 
         for (const auto& rect : SPRITE2_ANIMATIONRECTS ) {
             SPRITE2_BITMASK.emplace_back(createBitmask(SPRITE2_TEXTURE, rect, 0));
+            bitmask::getRotatedMaskCache().warm(SPRITE2_BITMASK.back(), rect.width, rect.height); // pawns turn, every angle now
         }
 
         BUTTON1_ANIMATIONRECTS.reserve(BUTTON1_INDEXMAX);
@@ -445,24 +453,20 @@ namespace Constants {
         unsigned int width = rect.width;
         unsigned int height = rect.height;
 
-        unsigned int bitmaskSize = (width * height) / 8 + ((width * height) % 8 != 0); // rounding up
-        std::shared_ptr<sf::Uint8[]> bitmask(new sf::Uint8[bitmaskSize](), std::default_delete<sf::Uint8[]>());
+        std::shared_ptr<sf::Uint8[]> mask = bitmask::allocate(width, height); // rows padded to whole 64-bit words
 
         for (unsigned int y = 0; y < height; ++y) {
             for (unsigned int x = 0; x < width; ++x) {
                 sf::Color pixelColor = image.getPixel(rect.left + x, rect.top + y);
-                unsigned int bitIndex = y * width + x;
-                unsigned int byteIndex = bitIndex / 8;
-                unsigned int bitPosition = bitIndex % 8;
 
                 // Use transparency threshold if provided, otherwise default to alpha > 128
                 if ((transparency > 0.0f && pixelColor.a >= static_cast<sf::Uint8>(transparency * 255)) || 
                     (transparency <= 0.0f && pixelColor.a > 128)) {
-                    bitmask[byteIndex] |= (1 << bitPosition);
+                    bitmask::setPixel(mask.get(), width, x, y);
                 }
             }
         }
-        return bitmask;
+        return mask;
     }
 
     std::shared_ptr<sf::Uint8[]> createBitmaskForBottom(const std::shared_ptr<sf::Texture>& texture, const sf::IntRect& rect, const float transparency, int rows) {
@@ -484,8 +488,7 @@ namespace Constants {
         unsigned int width = rect.width;
         unsigned int height = rect.height;
 
-        unsigned int bitmaskSize = (width * height) / 8 + ((width * height) % 8 != 0); // rounding up
-        std::shared_ptr<sf::Uint8[]> bitmask(new sf::Uint8[bitmaskSize](), std::default_delete<sf::Uint8[]>());
+        std::shared_ptr<sf::Uint8[]> mask = bitmask::allocate(width, height); // rows padded to whole 64-bit words
 
         // Start processing only the last selected rows of the rectangle
         unsigned int startRow = (height >= rows) ? height - rows : 0;
@@ -493,30 +496,23 @@ namespace Constants {
         for (unsigned int y = startRow; y < height; ++y) {
             for (unsigned int x = 0; x < width; ++x) {
                 sf::Color pixelColor = image.getPixel(rect.left + x, rect.top + y);
-                unsigned int bitIndex = y * width + x;
-                unsigned int byteIndex = bitIndex / 8;
-                unsigned int bitPosition = bitIndex % 8;
 
                 // Use transparency threshold if provided, otherwise default to alpha > 128
                 if ((transparency > 0.0f && pixelColor.a >= static_cast<sf::Uint8>(transparency * 255)) || 
                     (transparency <= 0.0f && pixelColor.a > 128)) {
-                    bitmask[byteIndex] |= (1 << bitPosition);
+                    bitmask::setPixel(mask.get(), width, x, y);
                 }
             }
         }
 
-        return bitmask;
+        return mask;
     }
-    void printBitmaskDebug(const std::shared_ptr<sf::Uint8[]>& bitmask, unsigned int width, unsigned int height) {
+    void printBitmaskDebug(const std::shared_ptr<sf::Uint8[]>& mask, unsigned int width, unsigned int height) {
         std::stringstream bitmaskStream;
 
         for (unsigned int y = 0; y < height; ++y) {
             for (unsigned int x = 0; x < width; ++x) {
-                unsigned int bitIndex = y * width + x;
-                unsigned int byteIndex = bitIndex / 8;
-                int bitPosition = 7 - (bitIndex % 8); // High bit to low bit order
-
-                if (bitmask[byteIndex] & (1 << bitPosition)) {
+                if (bitmask::getPixel(mask.get(), width, x, y)) {
                     bitmaskStream << '1';
                 } else {
                     bitmaskStream << '0';
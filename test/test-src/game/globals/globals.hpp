@@ -212,10 +212,6 @@ namespace Constants { // not actually "constants" in terms of being fixed, but s
     inline sf::Vector2f BACKGROUNDBIGFINAL_POSITION;
     inline sf::Vector2f BACKGROUNDBIGFINAL_SCALE;
     inline std::shared_ptr<sf::Texture> BACKGROUNDBIGFINAL_TEXTURE = std::make_shared<sf::Texture>();
-    inline std::filesystem::path BACKGROUNDBIGHALF_PATH;
-    inline sf::Vector2f BACKGROUNDBIGHALF_POSITION;
-    inline sf::Vector2f BACKGROUNDBIGHALF_SCALE;
-    inline std::shared_ptr<sf::Texture> BACKGROUNDBIGHALF_TEXTURE = std::make_shared<sf::Texture>();
     
     inline std::filesystem::path BACKGROUND1_PATH;
     inline std::filesystem::path BACKGROUND2_PATH;
@@ -244,6 +240,18 @@ namespace Constants { // not actually "constants" in terms of being fixed, but s
     inline size_t BOARDTILES_ROW;
     inline size_t BOARDTILES_COL;
 
+    // Computer opponent settings
+    inline bool AI_ENABLED;
+    inline bool AI_PLAYS_RED;
+    inline std::string AI_ENGINE;
+    inline unsigned int AI_TIME_BUDGET_MS;
+    inline unsigned short AI_MAX_DEPTH;
+    inline unsigned int AI_TT_SIZE_MB;
+    inline unsigned int AI_THREADS;
+    inline std::string AI_MCTS_POLICY;
+    inline float AI_MCTS_EXPLORATION;
+    inline unsigned int AI_MCTS_NODE_LIMIT;
+
     // Text settings
     inline unsigned short TEXT_SIZE;
     inline std::filesystem::path TEXT_PATH;
@@ -378,7 +386,9 @@ namespace FlagSystem {
         bool stickPlaced; // true if player placed a stick
         bool moved; // true if player moved
 
-        GameSceneEvents1() : sceneEnd(false), sceneStart(false), begin(false), playerBlueTurn(true), playerRedTurn(false), stickPlaced(false), moved(false) {}
+        bool computerOpponent; // true if one side is played by the ai
+
+        GameSceneEvents1() : sceneEnd(false), sceneStart(false), begin(false), playerBlueTurn(true), playerRedTurn(false), stickPlaced(false), moved(false), computerOpponent(false) {}
 
           void resetFlags() {
             sceneEnd = false;
@@ -388,6 +398,7 @@ namespace FlagSystem {
             playerRedTurn = false;
             stickPlaced = false;
             moved = false;
+            computerOpponent = false;
             log_info("Reset GameSceneEvents1 flags");
         }
     };
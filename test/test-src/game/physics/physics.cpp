@@ -1,122 +1,8 @@
 #include "physics.hpp"
 
 namespace physics {
-    Quadtree::Quadtree(float x, float y, float width, float height, size_t level, size_t maxObjects, size_t maxLevels)
-        : maxObjects(maxObjects), maxLevels(maxLevels), level(level), bounds(x, y, width, height) {}
-
-    void Quadtree::clear() {
-        objects.clear();
-        log_info("objects cleared.");
-        nodes.clear();
-        log_info("Quadtree cleared.");
-    }
-
-    std::vector<Sprite*> Quadtree::query(const sf::FloatRect& area) const {
-        try {
-            std::vector<Sprite*> result;
-            if (!bounds.intersects(area)) {
-                log_warning("Area does not intersect with the quadtree bounds at level " + std::to_string(level));
-                return result;
-            }
-
-            for (const auto& obj : objects) {
-                if (area.intersects(obj->returnSpritesShape().getGlobalBounds())) {
-                    result.push_back(obj);
-                    log_info("Sprite added to query result at level " + std::to_string(level));
-                }
-            }
-
-            for (const auto& node : nodes) {
-                auto nodeResult = node->query(area);
-                result.insert(result.end(), nodeResult.begin(), nodeResult.end());
-            }
-            return result;
-
-        } catch (const std::exception& e) {
-            log_error("Error during query at level " + std::to_string(level) + ": " + std::string(e.what()));
-            return std::vector<Sprite*>();
-        }
-    }
-
-    bool Quadtree::contains(const sf::FloatRect& bounds) const {
-        try {
-            bool result = this->bounds.contains(bounds.left, bounds.top) && this->bounds.contains(bounds.left + bounds.width, bounds.top + bounds.height);
-            log_info(result ? "Bounds are contained in the quadtree at level " + std::to_string(level) :
-                            "Bounds are not contained in the quadtree at level " + std::to_string(level));
-            return result;
-        } catch (const std::exception& e) {
-            log_error("Error during contains check at level " + std::to_string(level) + ": " + std::string(e.what()));
-            return false;
-        }
-    }
-
-    void Quadtree::subdivide() {
-        try {
-            // Check if we've reached the max level
-            if (level >= maxLevels) {
-                log_info("Maximum level reached, cannot subdivide further.");
-                return;
-            }
-
-            float halfWidth = bounds.width / 2;
-            float halfHeight = bounds.height / 2;
-            float x = bounds.left;
-            float y = bounds.top;
-
-            // Create four child nodes with smaller bounds and increment the level
-            nodes.push_back(std::make_unique<Quadtree>(x, y, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
-            nodes.push_back(std::make_unique<Quadtree>(x + halfWidth, y, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
-            nodes.push_back(std::make_unique<Quadtree>(x, y + halfHeight, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
-            nodes.push_back(std::make_unique<Quadtree>(x + halfWidth, y + halfHeight, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
-
-            log_info("Quadtree subdivided into 4 child nodes at level " + std::to_string(level));
-
-            // Redistribute the objects into the appropriate child nodes
-            for (auto it = objects.begin(); it != objects.end(); ) {
-                bool inserted = false;
-                for (auto& node : nodes) {
-                    if (node->bounds.intersects((*it)->returnSpritesShape().getGlobalBounds())) {
-                        node->objects.push_back(*it);
-                        it = objects.erase(it); // Remove object from the current node
-                        inserted = true;
-                        log_info("Sprite moved to child node at level " + std::to_string(node->level));
-                        break;
-                    }
-                }
-                if (!inserted) {
-                    ++it;
-                }
-            }
-        } catch (const std::exception& e) {
-            log_error("Error during subdivision at level " + std::to_string(level) + ": " + std::string(e.what()));
-        }
-    }
-
-    void Quadtree::update() {
-        try {
-            for (auto& sprite : objects) {
-              //  log_info("Updating quadtree at level " + std::to_string(level));
-
-                if (sprite->getMoveState()) {
-                    // Check which node the sprite was in
-                    for (auto& node : nodes) {
-                        if (node->contains(sprite->returnSpritesShape().getGlobalBounds())) {
-                            // Remove sprite from the old node
-                            node->objects.erase(std::remove(node->objects.begin(), node->objects.end(), sprite), node->objects.end());
-                            log_info("Sprite removed from old node at level " + std::to_string(node->level));
-                            break;
-                        }
-                    }
-
-                    // Insert the sprite back into the quadtree
-                    std::unique_ptr<Sprite> spritePtr(sprite);
-                    insert(spritePtr);
-                    log_info("Sprite updated and inserted into quadtree at level " + std::to_string(level));
-                }
-            }
-        } catch (const std::exception& e) {
-            log_error("Error during update at level " + std::to_string(level) + ": " + std::string(e.what()));
-        }
+    void Quadtree::update() { // the tree only keeps bounds, this is where it can ask the sprites
+        update([](Sprite* sprite) { return sprite->returnSpritesShape().getGlobalBounds(); });
     }
 
     // struct to hold raycast operation results that use vector of sprites
@@ -199,244 +85,208 @@ namespace physics {
         return originalPos;
     }
 
-    void calculateRayCast3d(std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, sf::VertexArray& lines, sf::VertexArray& wallLine) {
+    float getViewHeading(const std::unique_ptr<Player>& player) {
+        size_t itCount = Constants::RAYS_NUM / 2;
+        return raycast::snapHeading(player->getHeadingAngle(), itCount ? Constants::FOV / static_cast<float>(itCount) : 0.0f);
+    }
+
+    bool prepareRayCast(std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, sf::VertexArray& lines, sf::VertexArray& wallLine, raycast::RayFan& fan, RayCastFrame& frame, RayCastCache* cache) {
+        frame.rayCount = 0;
         if(!player || !tileMap){
             log_error("tile or player is not initialized");
-            return;
+            return false;
         }
 
-        float startX = player->getSpritePos().x;
-        float startY = player->getSpritePos().y;
-        float playerAngle = player->getHeadingAngle() * 3.14159f / 180.0f; // Convert to radians once
-
         size_t itCount = Constants::RAYS_NUM / 2;
         float screenWidth = static_cast<float>(MetaComponents::leftView.getSize().x);
         float screenHeight = static_cast<float>(MetaComponents::leftView.getSize().y);
         float centerY = screenHeight * 0.5f;
 
         const float wallHeightScale = 2500.0f;
-        float angleStep = Constants::FOV / static_cast<float>(itCount) * 3.14159f / 180.0f; // Convert to radians
-        const float maxRayDistance = 1000.0f;
-        const float stepSize = 1.0f;
-        const float maxSteps = maxRayDistance / stepSize;
-
-        static bool lookupInitialized = false;
-        if (!lookupInitialized) {
-            initializeTilemapLookup(tileMap, lookup);
-            lookupInitialized = true;
+        sf::Vector2f start = player->getSpritePos();
+        float stepDegrees = itCount ? Constants::FOV / static_cast<float>(itCount) : 0.0f;
+        float headingDegrees = getViewHeading(player);
+        uint64_t wallVersion = tileMap->getWallVersion();
+        sf::Vector2f viewSize(screenWidth, screenHeight);
+
+        // rays kept from the last cast, shifted by whole ray steps (positive turns right)
+        long shift = 0;
+        bool reuse = cache && cache->valid && itCount && cache->rayCount == itCount && cache->start == start && cache->wallVersion == wallVersion
+            && cache->stepDegrees == stepDegrees && cache->viewSize == viewSize && fan.count == itCount
+            && lines.getVertexCount() == 2 * itCount && wallLine.getVertexCount() == 4 * itCount;
+        if (reuse) {
+            reuse = raycast::getLatticeShift(cache->heading, headingDegrees, stepDegrees, itCount, shift);
+            if (reuse && shift == 0) return false; // nothing moved, last frame's vertex arrays are still right
+        }
+        if (cache) {
+            cache->heading = headingDegrees;
+            cache->valid = itCount != 0;
+            cache->start = start;
+            cache->stepDegrees = stepDegrees;
+            cache->rayCount = itCount;
+            cache->wallVersion = wallVersion;
+            cache->viewSize = viewSize;
         }
 
-        wallLine.clear();
-        wallLine.setPrimitiveType(sf::Quads);
-        lines.clear();
-        lines.setPrimitiveType(sf::Lines);
-        lines.resize(2 * itCount);
+        frame.traceBegin = 0;
+        frame.traceEnd = itCount;
+        if (reuse) {
+            // ray i now looks where ray i + shift looked, only the rays that came into view get traced
+            size_t kept = itCount - static_cast<size_t>(std::abs(shift));
+            size_t from = shift > 0 ? static_cast<size_t>(shift) : 0;
+            size_t to = shift > 0 ? 0 : static_cast<size_t>(-shift);
+            std::memmove(&fan.distance[to], &fan.distance[from], kept * sizeof(float));
+            std::memmove(&fan.hit[to], &fan.hit[from], kept * sizeof(float));
+            std::memmove(&fan.side[to], &fan.side[from], kept * sizeof(int32_t));
+            std::memmove(&lines[2 * to], &lines[2 * from], 2 * kept * sizeof(sf::Vertex));
+            frame.traceBegin = shift > 0 ? kept : 0;
+            frame.traceEnd = shift > 0 ? itCount : to;
+        } else {
+            lines.clear();
+            lines.setPrimitiveType(sf::Lines);
+            lines.resize(2 * itCount);
+        }
 
-        float sliceWidth = screenWidth / static_cast<float>(itCount);
+        // one quad per ray, the buffer only reallocates when rays_num changes
+        wallLine.setPrimitiveType(sf::Quads);
+        if (wallLine.getVertexCount() != 4 * itCount) wallLine.resize(4 * itCount);
+        if (itCount == 0) return false;
 
-        // Pre-calculate brightness lookup table
+        // Pre-calculate brightness lookup table, north/south faces a bit darker so corners read
         const float maxDistance = 100.0f;
-        const int brightnessLevels = 256;
-        static std::array<sf::Color, brightnessLevels> brightnessLUT;
+        const int brightnessLevels = raycast::SHADE_LEVELS;
+        const float sideShade = 0.8f;
+        static std::array<std::array<sf::Color, brightnessLevels>, 2> brightnessLUT;
         static bool lutInitialized = false;
         if (!lutInitialized) {
-            for (int i = 0; i < brightnessLevels; ++i) {
-                float distance = (i / float(brightnessLevels - 1)) * maxDistance;
-                float brightnessFactor = std::max(0.2f, 1.0f - (distance / maxDistance));
-                brightnessLUT[i] = sf::Color(
-                    Constants::WALL_COLOR.r * brightnessFactor,
-                    Constants::WALL_COLOR.g * brightnessFactor,
-                    Constants::WALL_COLOR.b * brightnessFactor
-                );
+            for (int side = 0; side < 2; ++side) {
+                for (int i = 0; i < brightnessLevels; ++i) {
+                    float distance = (i / float(brightnessLevels - 1)) * maxDistance;
+                    float brightnessFactor = std::max(0.2f, 1.0f - (distance / maxDistance)) * (side ? sideShade : 1.0f);
+                    brightnessLUT[side][i] = sf::Color(
+                        Constants::WALL_COLOR.r * brightnessFactor,
+                        Constants::WALL_COLOR.g * brightnessFactor,
+                        Constants::WALL_COLOR.b * brightnessFactor
+                    );
+                }
             }
             lutInitialized = true;
         }
 
-        for (size_t i = 0; i < itCount; ++i) {
-            float angleOffset = (i - itCount * 0.5f) * angleStep;
-            float rayAngle = playerAngle + angleOffset;
-        
-            // Use fast trigonometry
-            float dirX = std::cos(rayAngle);
-            float dirY = std::sin(rayAngle);
-
-            float rayX = startX;
-            float rayY = startY;
-            float rayDistance = 0.0f;
-            int steps = 0;
-
-            // DDA-style raycasting with larger steps when far from walls
-            while (steps < maxSteps) {
-                // Adaptive step size - use larger steps when far from obstacles
-                float currentStepSize = stepSize;
-                if (steps > 10) currentStepSize = stepSize * 2.0f; // Double step size for distant checks
-
-                rayX += dirX * currentStepSize;
-                rayY += dirY * currentStepSize;
-                rayDistance += currentStepSize;
-                steps++;
-
-                // Fast tile lookup using spatial grid
-                auto hitTile = fastTileLookup(lookup, rayX, rayY);
-                
-                if (!hitTile) break; // Out of bounds
-
-                if (!hitTile->getWalkable()) {
-                    // Hit a wall - do precision check if we used large steps
-                    if (currentStepSize > stepSize) {
-                        // Step back and do precision check
-                        rayX -= dirX * currentStepSize;
-                        rayY -= dirY * currentStepSize;
-                        rayDistance -= currentStepSize;
-                        
-                        // Precision steps
-                        while (rayDistance < maxRayDistance) {
-                            rayX += dirX * stepSize;
-                            rayY += dirY * stepSize;
-                            rayDistance += stepSize;
-                            
-                            auto precisionTile = fastTileLookup(lookup, rayX, rayY);
-                            if (!precisionTile || !precisionTile->getWalkable()) break;
-                        }
-                    }
-
-                    // Store raycasting lines for debugging
-                    lines[2 * i].position = sf::Vector2f(startX, startY);
-                    lines[2 * i + 1].position = sf::Vector2f(rayX, rayY);
-                    lines[2 * i].color = sf::Color::Red;
-                    lines[2 * i + 1].color = sf::Color::Red;
-
-                    // Correct fish-eye effect
-                    float correctedDistance = rayDistance * std::cos(rayAngle - playerAngle);
-                    correctedDistance = std::max(1.0f, correctedDistance);
-
-                    // Compute projected wall height
-                    float wallHeight = wallHeightScale / correctedDistance;
-
-                    // Compute screen position for this wall slice
-                    float screenX = i * sliceWidth;
-                    float wallTopY = centerY - wallHeight * 0.5f;
-                    float wallBottomY = centerY + wallHeight * 0.5f;
-
-                    // Fast brightness lookup
-                    int lutIndex = std::min(brightnessLevels - 1, static_cast<int>((correctedDistance / maxDistance) * brightnessLevels));
-                    sf::Color wallColor = brightnessLUT[lutIndex];
-
-                    // Define quad vertices for the wall slice
-                    wallLine.append(sf::Vertex(sf::Vector2f(screenX, wallTopY), wallColor));
-                    wallLine.append(sf::Vertex(sf::Vector2f(screenX + sliceWidth, wallTopY), wallColor));
-                    wallLine.append(sf::Vertex(sf::Vector2f(screenX + sliceWidth, wallBottomY), wallColor));
-                    wallLine.append(sf::Vertex(sf::Vector2f(screenX, wallBottomY), wallColor));
-                    
-                    break; // Ray hit wall, move to next ray
-                }
-            }
-        }
+        fan.resize(itCount);
+
+        frame.start = start;
+        frame.heading = headingDegrees * 3.14159f / 180.0f; // Convert to radians once
+        frame.angleStep = stepDegrees * 3.14159f / 180.0f; // Convert to radians
+        raycast::buildOffsetTable(fan, frame.angleStep); // only does work when FOV or rays_num changed
+        frame.rayCount = itCount;
+        frame.projection.sliceWidth = screenWidth / static_cast<float>(itCount);
+        frame.projection.centerY = centerY;
+        frame.projection.wallHeightScale = wallHeightScale;
+        frame.projection.maxDistance = maxDistance;
+        frame.projection.shades[0] = brightnessLUT[0].data();
+        frame.projection.shades[1] = brightnessLUT[1].data();
+        frame.fan = &fan;
+        frame.lines = &lines;
+        frame.wallLine = &wallLine;
+        frame.tileMap = tileMap.get();
+        return true;
     }
 
-    void initializeTilemapLookup(std::unique_ptr<BoardTileMap>& tileMap, TilemapLookup& lookup) {
-        lookup.allTiles.clear();
-
-        size_t num = tileMap->getTileMapNumber(); 
-
-        lookup.allTiles.reserve(num);
-        
-        // Calculate bounds and collect tiles
-        bool first = true;
-        for (size_t i = 0; i < num; ++i) {
-            auto tile = tileMap->getTile(i);
-            if (tile) {
-                lookup.allTiles.push_back(tile);
-                sf::Vector2f pos = tile->getTileSprite().getPosition();
-                sf::Vector2f scale = tile->getTileSprite().getScale();
-                sf::IntRect rect = tile->getTextureRect();
-                
-                float tileWidth = rect.width * scale.x;
-                float tileHeight = rect.height * scale.y;
-                
-                if (first) {
-                    lookup.minX = pos.x;
-                    lookup.minY = pos.y;
-                    lookup.maxX = pos.x + tileWidth;
-                    lookup.maxY = pos.y + tileHeight;
-                    lookup.tileWidth = tileWidth;
-                    lookup.tileHeight = tileHeight;
-                    first = false;
-                } else {
-                    lookup.minX = std::min(lookup.minX, pos.x);
-                    lookup.minY = std::min(lookup.minY, pos.y);
-                    lookup.maxX = std::max(lookup.maxX, pos.x + tileWidth);
-                    lookup.maxY = std::max(lookup.maxY, pos.y + tileHeight);
-                }
-            }
-        }
-        
-        // Create spatial grid for faster lookups
-        const int gridResolution = 32; // Adjust based on tile density
-        lookup.gridWidth = gridResolution;
-        lookup.gridHeight = gridResolution;
-        lookup.spatialGrid.resize(gridResolution * gridResolution);
-        
-        float cellWidth = (lookup.maxX - lookup.minX) / gridResolution;
-        float cellHeight = (lookup.maxY - lookup.minY) / gridResolution;
-        
-        // Populate spatial grid
-        for (auto& tile : lookup.allTiles) {
-            sf::Vector2f pos = tile->getTileSprite().getPosition();
-            sf::Vector2f scale = tile->getTileSprite().getScale();
-            sf::IntRect rect = tile->getTextureRect();
-            
-            float tileWidth = rect.width * scale.x;
-            float tileHeight = rect.height * scale.y;
-            
-            // Find which grid cells this tile overlaps
-            int startX = std::max(0, static_cast<int>((pos.x - lookup.minX) / cellWidth));
-            int endX = std::min(gridResolution - 1, static_cast<int>((pos.x + tileWidth - lookup.minX) / cellWidth));
-            int startY = std::max(0, static_cast<int>((pos.y - lookup.minY) / cellHeight));
-            int endY = std::min(gridResolution - 1, static_cast<int>((pos.y + tileHeight - lookup.minY) / cellHeight));
-            
-            for (int y = startY; y <= endY; ++y) {
-                for (int x = startX; x <= endX; ++x) lookup.spatialGrid[y * gridResolution + x].push_back(tile);
+    void castRayRange(const RayCastFrame& frame, size_t begin, size_t end) {
+        end = std::min(end, frame.rayCount);
+        if (begin >= end) return;
+
+        // directions a packet at a time, traversal per ray, then projection a packet at a time
+        raycast::RayFan& fan = *frame.fan;
+        sf::VertexArray& lines = *frame.lines;
+        raycast::computeDirections(fan, frame.heading, begin, end);
+
+        size_t traceBegin = std::max(begin, frame.traceBegin);
+        size_t traceEnd = std::min(end, frame.traceEnd);
+        for (size_t i = traceBegin; i < traceEnd; ++i) {
+            RayHit hit = castRayDDA(*frame.tileMap, frame.start, sf::Vector2f(fan.dirX[i], fan.dirY[i]), frame.maxRayDistance);
+            fan.distance[i] = hit.distance;
+            fan.hit[i] = hit.hit ? 1.0f : 0.0f;
+            fan.side[i] = hit.side;
+            if (!hit.hit) { // left the board or ran out of range, slice stays empty
+                lines[2 * i] = sf::Vertex();
+                lines[2 * i + 1] = sf::Vertex();
+                continue;
             }
+
+            // Store raycasting lines for debugging
+            lines[2 * i].position = frame.start;
+            lines[2 * i + 1].position = hit.point;
+            lines[2 * i].color = sf::Color::Red;
+            lines[2 * i + 1].color = sf::Color::Red;
         }
-    }
 
-    // Optimized point-in-tile check with early termination
-    bool isPointInTile(const std::shared_ptr<Tile>& tile, float worldX, float worldY) {
-        sf::Vector2f tilePos = tile->getTileSprite().getPosition();
-        
-        if (worldX < tilePos.x || worldY < tilePos.y) return false;        // Early rejection tests
-        
-        sf::Vector2f tileScale = tile->getTileSprite().getScale();
-        sf::IntRect textureRect = tile->getTextureRect();
-        
-        float tileWidth = textureRect.width * tileScale.x;
-        float tileHeight = textureRect.height * tileScale.y;
-        
-        return (worldX < tilePos.x + tileWidth && worldY < tilePos.y + tileHeight);
+        raycast::projectWalls(fan, frame.projection, &(*frame.wallLine)[0], begin, end);
     }
 
-    std::shared_ptr<Tile> fastTileLookup(const TilemapLookup& lookup, float worldX, float worldY) {
-        // Fast bounds check
-        if (worldX < lookup.minX || worldX > lookup.maxX || worldY < lookup.minY || worldY > lookup.maxY) return nullptr;
-        
-        // Find grid cell
-        int gridX = static_cast<int>((worldX - lookup.minX) / (lookup.maxX - lookup.minX) * lookup.gridWidth);
-        int gridY = static_cast<int>((worldY - lookup.minY) / (lookup.maxY - lookup.minY) * lookup.gridHeight);
-        
-        gridX = std::clamp(gridX, 0, lookup.gridWidth - 1);
-        gridY = std::clamp(gridY, 0, lookup.gridHeight - 1);
-        
-        int cellIndex = gridY * lookup.gridWidth + gridX;
-        
-        // Check tiles in this grid cell
-        for (const auto& tile : lookup.spatialGrid[cellIndex]) {
-            if (isPointInTile(tile, worldX, worldY)) return tile;
+    RayHit castRayDDA(const BoardTileMap& tileMap, sf::Vector2f start, sf::Vector2f direction, float maxDistance) {
+        RayHit result;
+        const std::vector<float>& rowOffsets = tileMap.getRowOffsets();
+        size_t rows = tileMap.getRowsTotal();
+        size_t cols = tileMap.getColsTotal();
+
+        // board relative coordinates, offsets start at 0
+        float x = start.x - tileMap.getBoardOrigin().x;
+        float y = start.y - tileMap.getBoardOrigin().y;
+        if (x < 0.0f || y < 0.0f || y >= rowOffsets[rows]) return result;
+
+        int row = static_cast<int>(std::upper_bound(rowOffsets.begin(), rowOffsets.end(), y) - rowOffsets.begin()) - 1;
+        const float* colOffsets = tileMap.getColOffsets(row);
+        if (x >= colOffsets[cols]) return result;
+        int col = static_cast<int>(std::upper_bound(colOffsets, colOffsets + cols + 1, x) - colOffsets) - 1;
+
+        int stepRow = direction.y > 0.0f ? 1 : -1;
+        int stepCol = direction.x > 0.0f ? 1 : -1;
+        float distance = 0.0f;
+        int side = 0;
+
+        // every iteration crosses exactly one tile edge, so the cost is the number of tiles the ray passes
+        while (distance <= maxDistance) {
+            size_t index = static_cast<size_t>(row) * cols + col;
+            if (!tileMap.isTileWalkable(index)) {
+                result.hit = true;
+                result.distance = distance;
+                result.point = start + direction * distance;
+                result.side = side;
+                result.tileIndex = index;
+                return result;
+            }
+
+            // distance to the next row edge and to the next column edge inside this row
+            float toRowEdge = std::numeric_limits<float>::infinity();
+            if (direction.y != 0.0f) toRowEdge = (rowOffsets[row + (stepRow > 0)] - y) / direction.y;
+            float toColEdge = std::numeric_limits<float>::infinity();
+            if (direction.x != 0.0f) toColEdge = (colOffsets[col + (stepCol > 0)] - x) / direction.x;
+
+            if (toColEdge < toRowEdge) {
+                distance = toColEdge;
+                col += stepCol;
+                side = 0;
+                if (col < 0 || col >= static_cast<int>(cols)) return result;
+            } else {
+                distance = toRowEdge;
+                row += stepRow;
+                side = 1;
+                if (row < 0 || row >= static_cast<int>(rows)) return result;
+
+                // rows don't share column widths (the border rows), find the column again where the ray enters
+                colOffsets = tileMap.getColOffsets(row);
+                float enterX = x + direction.x * distance;
+                if (enterX < 0.0f || enterX >= colOffsets[cols]) return result;
+                col = static_cast<int>(std::upper_bound(colOffsets, colOffsets + cols + 1, enterX) - colOffsets) - 1;
+                if (stepCol < 0 && col > 0 && enterX == colOffsets[col]) --col; // on an edge while heading west, the west tile is next
+            }
         }
-        return nullptr;
+        return result;
     }
 
-    void calculateSprite3D(std::unique_ptr<Sprite>& sprite, std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, bool& blockedView) {
+    void calculateSprite3D(std::unique_ptr<Sprite>& sprite, std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap) {
         if (!sprite || !player || !tileMap) {
             log_error("sprite, player, or tilemap is not initialized");
             return;
@@ -458,12 +308,8 @@ namespace physics {
             return;
         }
         
-        // Perform line-of-sight check using BoardTileMap
-        bool hasLineOfSight = checkLineOfSightWithTileMap(playerPos, spritePos, tileMap);
-        blockedView = !hasLineOfSight;
-        
         // Calculate angle from player to sprite
-        float playerAngle = player->getHeadingAngle() * 3.14159f / 180.0f;
+        float playerAngle = getViewHeading(player) * 3.14159f / 180.0f; // the walls' heading, so the pawn lines up with their columns
         float spriteAngle = std::atan2(deltaY, deltaX);
         float angleDiff = spriteAngle - playerAngle;
         
@@ -519,68 +365,47 @@ namespace physics {
         sprite->returnSpritesShape().setColor(sf::Color(colorValue, colorValue, colorValue, 255));
     }
 
-    // Updated helper function for line-of-sight checking using BoardTileMap
-    bool checkLineOfSightWithTileMap(sf::Vector2f start, sf::Vector2f end, std::unique_ptr<BoardTileMap>& tileMap) {
-        
-        float deltaX = end.x - start.x;
-        float deltaY = end.y - start.y;
-        float distance = std::sqrt(deltaX * deltaX + deltaY * deltaY);
-        
-        if (distance < 1.0f) return true; // Very close, assume visible
-        
-        // Normalize direction
-        float dirX = deltaX / distance;
-        float dirY = deltaY / distance;
-        
-        // Step along the line checking for walls and barriers
-        const float stepSize = 2.0f; // Smaller steps for more accuracy
-        float currentDistance = 0.0f;
-        
-        while (currentDistance < distance) {
-            float checkX = start.x + dirX * currentDistance;
-            float checkY = start.y + dirY * currentDistance;
-            
-            // Get tile index from world position
-            size_t tileIndex = tileMap->getTileIndex(sf::Vector2f(checkX, checkY));
-            
-            // Check if the tile index is valid (within bounds)
-            if (tileIndex < tileMap->getTileMapNumber()) {
-                auto& tile = tileMap->getTile(tileIndex);
-                
-                // Check if tile exists and is not walkable (wall or barrier like placed stick)
-                if (tile && !tile->getWalkable()) return false; // Line of sight blocked by wall or barrier
-            }
-            currentDistance += stepSize;
-        }
-        return true; // Clear line of sight
-    }
-
-    // Alternative version for more precise checking
-    bool checkLineOfSightWithTileMapPrecise(sf::Vector2f start, sf::Vector2f end, std::unique_ptr<BoardTileMap>& tileMap) {
-        
-        float deltaX = end.x - start.x;
-        float deltaY = end.y - start.y;
-        float distance = std::sqrt(deltaX * deltaX + deltaY * deltaY);
-        
-        if (distance < 1.0f) return true;
-        
-        // Use Bresenham-like algorithm for more precise tile checking
-        int steps = static_cast<int>(distance / 1.0f); // Check every pixel essentially
-        
-        for (int i = 0; i <= steps; ++i) {
-            float t = static_cast<float>(i) / static_cast<float>(steps);
-            float checkX = start.x + deltaX * t;
-            float checkY = start.y + deltaY * t;
-            
-            size_t tileIndex = tileMap->getTileIndex(sf::Vector2f(checkX, checkY));
-            
-            if (tileIndex < tileMap->getTileMapNumber()) {
-                auto& tile = tileMap->getTile(tileIndex);
-                
-                if (tile && !tile->getWalkable()) return false;
+    void clipSprite3D(const std::unique_ptr<Sprite>& sprite, const std::unique_ptr<Player>& player, const raycast::RayFan& fan, sf::VertexArray& slices) {
+        if (!sprite || !player || !sprite->getVisibleState() || fan.count == 0) return;
+
+        const sf::Sprite& shape = sprite->returnSpritesShape();
+        sf::FloatRect bounds = shape.getGlobalBounds();
+        float sliceWidth = static_cast<float>(MetaComponents::leftView.getSize().x) / static_cast<float>(fan.count);
+        if (bounds.width <= 0.0f || sliceWidth <= 0.0f) return;
+
+        // same fish-eye corrected distance the wall columns store
+        sf::Vector2f delta = sprite->getSpritePos() - player->getSpritePos();
+        float angleDiff = std::atan2(delta.y, delta.x) - getViewHeading(player) * 3.14159f / 180.0f;
+        float depth = std::sqrt(delta.x * delta.x + delta.y * delta.y) * std::cos(angleDiff);
+
+        sf::IntRect rect = shape.getTextureRect();
+        sf::Color color = shape.getColor();
+        float right = bounds.left + bounds.width;
+        float bottom = bounds.top + bounds.height;
+        size_t first = static_cast<size_t>(std::max(0.0f, std::floor(bounds.left / sliceWidth)));
+        size_t last = static_cast<size_t>(std::clamp(std::ceil(right / sliceWidth), 0.0f, static_cast<float>(fan.count)));
+
+        size_t column = first;
+        while (column < last) {
+            if (!(depth < fan.depth[column])) { // wall in front
+                ++column;
+                continue;
             }
+            size_t runEnd = column + 1;
+            while (runEnd < last && depth < fan.depth[runEnd]) ++runEnd;
+
+            float runLeft = std::max(bounds.left, column * sliceWidth);
+            float runRight = std::min(right, runEnd * sliceWidth);
+            float u0 = rect.left + (runLeft - bounds.left) / bounds.width * rect.width;
+            float u1 = rect.left + (runRight - bounds.left) / bounds.width * rect.width;
+            float v0 = static_cast<float>(rect.top);
+            float v1 = static_cast<float>(rect.top + rect.height);
+            slices.append(sf::Vertex(sf::Vector2f(runLeft, bounds.top), color, sf::Vector2f(u0, v0)));
+            slices.append(sf::Vertex(sf::Vector2f(runRight, bounds.top), color, sf::Vector2f(u1, v0)));
+            slices.append(sf::Vertex(sf::Vector2f(runRight, bottom), color, sf::Vector2f(u1, v1)));
+            slices.append(sf::Vertex(sf::Vector2f(runLeft, bottom), color, sf::Vector2f(u0, v1)));
+            column = runEnd;
         }
-        return true;
     }
 
     // circle collision 
@@ -686,97 +511,26 @@ namespace physics {
         return !(xOverlapStart >= xOverlapEnd || yOverlapStart >= yOverlapEnd); 
     }
 
+    // masks come from Constants::createBitmask, so size is the mask's size in pixels
     bool pixelPerfectCollision( const std::shared_ptr<sf::Uint8[]>& bitmask1, const sf::Vector2f& position1, const sf::Vector2f& size1,
                                 const std::shared_ptr<sf::Uint8[]>& bitmask2, const sf::Vector2f& position2, const sf::Vector2f& size2) {
-
-        // Helper function to get the pixel index in the bitmask
-        auto getPixelIndex = [](const sf::Vector2f& size, int x, int y) -> int {
-            return (y * static_cast<int>(size.x) + x) * 4; // Each pixel has 4 bytes (RGBA)
-        };
-
-        // Calculate the overlapping area between the two objects
-        float left = std::max(position1.x, position2.x);
-        float top = std::max(position1.y, position2.y);
-        float right = std::min(position1.x + size1.x, position2.x + size2.x);
-        float bottom = std::min(position1.y + size1.y, position2.y + size2.y);
-
-        // Check AABB collision first
-        if (left >= right || top >= bottom) return false; 
-        //std::cout << "AABB collision passed." << std::endl;
-        // Check each pixel in the overlapping area
-        for (int y = static_cast<int>(top); y < static_cast<int>(bottom); ++y) {
-            for (int x = static_cast<int>(left); x < static_cast<int>(right); ++x) {
-                // Calculate the position in each bitmask
-                int x1 = x - static_cast<int>(position1.x);
-                int y1 = y - static_cast<int>(position1.y);
-                int x2 = x - static_cast<int>(position2.x);
-                int y2 = y - static_cast<int>(position2.y);
-
-                // Get the index of the pixel in each bitmask
-                int index1 = getPixelIndex(size1, x1, y1);
-                int index2 = getPixelIndex(size2, x2, y2);
-
-                // Check if the pixels' values are non-zero (i.e., not transparent)
-                if (bitmask1[index1] == 1 && bitmask2[index2] == 1) {
-                    return true; // Collision detected
-                }
-            }
-        }
-        //std::cout << "Pixel perfect collision passed." << std::endl;
-        return false; 
+        return bitmask::overlaps(bitmask1.get(), static_cast<int>(position1.x), static_cast<int>(position1.y), static_cast<unsigned int>(size1.x), static_cast<unsigned int>(size1.y),
+                                 bitmask2.get(), static_cast<int>(position2.x), static_cast<int>(position2.y), static_cast<unsigned int>(size2.x), static_cast<unsigned int>(size2.y));
     }
 
+    // angles snap to the nearest 3 degrees and each mask turns about its own centre, positions and sizes are the
+    // unrotated masks'. The turned masks come from the cache, so this is the same word test as the unrotated case
     bool pixelPerfectCollision(const std::shared_ptr<sf::Uint8[]>& bitmask1, const sf::Vector2f& position1, const sf::Vector2f& size1,
         const std::shared_ptr<sf::Uint8[]>& bitmask2, const sf::Vector2f& position2, const sf::Vector2f& size2,
         float angle1, float angle2) {
 
-        // Helper function to get the pixel index in the bitmask
-        auto getPixelIndex = [](const sf::Vector2f& size, int x, int y) -> int {
-            return (y * static_cast<int>(size.x) + x) * 4; // Each pixel has 4 bytes (RGBA)
-        };
-
-        // Calculate the overlapping area between the two objects
-        float left = std::max(position1.x, position2.x);
-        float top = std::max(position1.y, position2.y);
-        float right = std::min(position1.x + size1.x, position2.x + size2.x);
-        float bottom = std::min(position1.y + size1.y, position2.y + size2.y);
-
-        // Check AABB collision first
-        if (left >= right || top >= bottom) return false;
-
-        // Helper function to rotate a point (x, y) around the center of the sprite
-        auto rotatePoint = [](float x, float y, float angle) -> sf::Vector2f {
-            float rad = angle * 3.14159f / 180.0f;
-            float cosAngle = std::cos(rad);
-            float sinAngle = std::sin(rad);
-            return sf::Vector2f(x * cosAngle - y * sinAngle, x * sinAngle + y * cosAngle);
-        };
-
-        // Check each pixel in the overlapping area
-        for (int y = static_cast<int>(top); y < static_cast<int>(bottom); ++y) {
-            for (int x = static_cast<int>(left); x < static_cast<int>(right); ++x) {
-
-                // Transform the pixel position to local coordinates of each sprite
-                int x1 = x - static_cast<int>(position1.x);
-                int y1 = y - static_cast<int>(position1.y);
-                int x2 = x - static_cast<int>(position2.x);
-                int y2 = y - static_cast<int>(position2.y);
-
-                // Apply rotation by reversing the rotation angle for each sprite
-                auto rotated1 = rotatePoint(x1, y1, -angle1);
-                auto rotated2 = rotatePoint(x2, y2, -angle2);
-
-                // Get the index of the pixel in each bitmask
-                int index1 = getPixelIndex(size1, static_cast<int>(rotated1.x), static_cast<int>(rotated1.y));
-                int index2 = getPixelIndex(size2, static_cast<int>(rotated2.x), static_cast<int>(rotated2.y));
-
-                // Check if the pixels' values are non-zero (i.e., not transparent)
-                if (bitmask1[index1] == 1 && bitmask2[index2] == 1) {
-                    return true; // Collision detected
-                }
-            }
-        }
-        return false;
+        bitmask::RotatedMaskCache& cache = bitmask::getRotatedMaskCache();
+        auto rotated1 = cache.get(bitmask1, static_cast<unsigned int>(size1.x), static_cast<unsigned int>(size1.y), angle1);
+        auto rotated2 = cache.get(bitmask2, static_cast<unsigned int>(size2.x), static_cast<unsigned int>(size2.y), angle2);
+        if (!rotated1 || !rotated2) return false;
+
+        return bitmask::overlaps(rotated1->mask.get(), static_cast<int>(position1.x) + rotated1->offsetX, static_cast<int>(position1.y) + rotated1->offsetY, rotated1->width, rotated1->height,
+                                 rotated2->mask.get(), static_cast<int>(position2.x) + rotated2->offsetX, static_cast<int>(position2.y) + rotated2->offsetY, rotated2->width, rotated2->height);
     }
     
 }
\ No newline at end of file
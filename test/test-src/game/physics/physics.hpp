@@ -10,51 +10,20 @@
 #include <math.h>
 #include <functional> 
 #include <utility>
+#include <limits>
+#include <cmath>
+#include <cstring>
 
 #include "../../test-assets/sprites/sprites.hpp" 
 #include "../../test-assets/tiles/tiles.hpp" 
+#include "../raycast/raycast.hpp"
+#include "../quadtree/quadtree.hpp"
+#include "../broadphase/broadphase.hpp"
+#include "../bitmask/bitmask.hpp"
 
 
 namespace physics{
 
-    class Quadtree {
-    public:
-        Quadtree(float x, float y, float width, float height, size_t level = 0, size_t maxObjects = 10, size_t maxLevels = 5);
-        ~Quadtree(){ clear(); };
-        void clear();
-
-        template<typename SpriteType> void insert(std::unique_ptr<SpriteType>& obj) { 
-            try {
-                if (nodes.empty()) { // If no child nodes exist, add the object to this node
-                    objects.push_back(obj.get());
-                    log_info("Sprite inserted into quadtree node.");
-                } else { // Check which child node the object belongs to
-                    for (auto& node : nodes) {
-                        if (node->bounds.contains(obj->returnSpritesShape().getPosition())) {
-                            node->insert(obj);
-                            log_info("Sprite inserted into child node.");
-                            return;
-                        }
-                    }
-                }
-            } catch (const std::exception& e) {
-                log_error("Error during insert: " + std::string(e.what()));
-            }
-        }
-        std::vector<Sprite*> query(const sf::FloatRect& area) const;
-        void subdivide();
-        bool contains(const sf::FloatRect& bounds) const;
-        void update(); 
-
-    private:
-        size_t maxObjects;
-        size_t maxLevels;
-        size_t level;
-        sf::FloatRect bounds;
-        std::vector<Sprite*> objects;
-        std::vector<std::unique_ptr<Quadtree>> nodes;
-    };
-
     // moving object
     constexpr float gravity = 9.8f;
     sf::Vector2f freeFall(float speed, sf::Vector2f originalPo);
@@ -96,26 +65,58 @@ namespace physics{
         sprite->updatePos();
     }
 
-    // specific to board tilemap
-    struct TilemapLookup {
-        float minX, minY, maxX, maxY;
-        float tileWidth, tileHeight;
-        int gridWidth, gridHeight;
-        std::vector<std::vector<std::shared_ptr<Tile>>> spatialGrid;
-        std::vector<std::shared_ptr<Tile>> allTiles;
+    // walls, cast in two steps: a serial setup that sizes the buffers, then ray ranges that only write their own
+    // rays, so several threads can fill one view and the output matches a single castRayRange over every ray
+    constexpr size_t RAY_CHUNK = raycast::PACKET_WIDTH * 8; // rays per job when a view is split across threads
+    struct RayCastFrame {
+        sf::Vector2f start {};
+        float heading = 0.0f; // radians
+        float angleStep = 0.0f;
+        float maxRayDistance = 1000.0f;
+        size_t rayCount = 0;
+        size_t traceBegin = 0; // rays that need a grid traversal, the rest kept their hit from the last frame
+        size_t traceEnd = 0;
+        raycast::WallProjection projection;
+        raycast::RayFan* fan = nullptr;
+        sf::VertexArray* lines = nullptr;
+        sf::VertexArray* wallLine = nullptr;
+        const BoardTileMap* tileMap = nullptr;
+
+        size_t getChunkCount() const { return (rayCount + RAY_CHUNK - 1) / RAY_CHUNK; }
     };
-    static TilemapLookup lookup;
 
-    // walls
-    void initializeTilemapLookup(std::unique_ptr<BoardTileMap>& tileMap, TilemapLookup& lookup);    
-    std::shared_ptr<Tile> fastTileLookup(const TilemapLookup& lookup, float worldX, float worldY);
-    bool isPointInTile(std::shared_ptr<Tile>& tile, float worldX, float worldY);
-    void calculateRayCast3d(std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, sf::VertexArray& lines, sf::VertexArray& wallLine); 
+    // what one view was last cast from. Same position, heading and walls means the vertex arrays are still right;
+    // headings snap onto the ray lattice, so any turn keeps the rays that stayed in view and only traces the ones that came in
+    struct RayCastCache {
+        bool valid = false;
+        sf::Vector2f start {};
+        float heading = 0.0f; // degrees, on the ray lattice of the last cast
+        float stepDegrees = 0.0f;
+        size_t rayCount = 0;
+        uint64_t wallVersion = 0;
+        sf::Vector2f viewSize {};
+    };
+    float getViewHeading(const std::unique_ptr<Player>& player); // degrees the 3D views draw at, the heading snapped onto the ray lattice
+    bool prepareRayCast(std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, sf::VertexArray& lines, sf::VertexArray& wallLine, raycast::RayFan& fan, RayCastFrame& frame, RayCastCache* cache = nullptr); // false if there is nothing to cast
+    void castRayRange(const RayCastFrame& frame, size_t begin, size_t end); // begin a multiple of raycast::PACKET_WIDTH
+    inline void castRayChunk(const RayCastFrame& frame, size_t chunk) { castRayRange(frame, chunk * RAY_CHUNK, (chunk + 1) * RAY_CHUNK); }
+
+    // exact grid traversal, steps from tile boundary to tile boundary over the board's variable size tiles
+    struct RayHit {
+        bool hit = false;
+        float distance = 0.0f; // along the ray, direction is unit length
+        sf::Vector2f point {};
+        int side = 0; // 0 if the ray crossed a vertical tile edge last (east/west face), 1 for a horizontal edge (north/south face)
+        size_t tileIndex = 0;
+    };
+    RayHit castRayDDA(const BoardTileMap& tileMap, sf::Vector2f start, sf::Vector2f direction, float maxDistance);
 
     // rescale sprite for 3D rendering
-    void calculateSprite3D(std::unique_ptr<Sprite>& sprite, std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap, bool& blockedView);
-    bool checkLineOfSightWithTileMap(sf::Vector2f start, sf::Vector2f end, std::unique_ptr<BoardTileMap>& tileMap);
-    bool checkLineOfSightWithTileMapPrecise(sf::Vector2f start, sf::Vector2f end, std::unique_ptr<BoardTileMap>& tileMap);
+    // places, scales and shades a sprite for a player's view, occlusion by walls is left to clipSprite3D
+    void calculateSprite3D(std::unique_ptr<Sprite>& sprite, std::unique_ptr<Player>& player, std::unique_ptr<BoardTileMap>& tileMap);
+    // cuts a sprite placed by calculateSprite3D into the wall columns it stands in front of, one textured quad per run of
+    // visible columns appended to slices. Sprites sharing a texture can share slices, append the farthest first
+    void clipSprite3D(const std::unique_ptr<Sprite>& sprite, const std::unique_ptr<Player>& player, const raycast::RayFan& fan, sf::VertexArray& slices);
 
     // raycast pre-collision in 2D space
     struct RaycastResult {
@@ -170,6 +171,31 @@ namespace physics{
         return data;
     }
 
+    // runs whichever narrow phase test func is, picked by its parameters
+    template<typename CollisionFunc>
+    bool narrowPhase(const CollisionData& d1, const CollisionData& d2, CollisionFunc&& func, float timeElapsed = 0.0f, size_t counterIndex = 0) {
+        if constexpr (std::is_invocable_v<CollisionFunc, sf::Vector2f, float, sf::Vector2f, float>) {
+            return func(d1.position, d1.radius, d2.position, d2.radius);
+        } else if constexpr (std::is_invocable_v<CollisionFunc, sf::Vector2f, sf::Vector2f, sf::Vector2f, sf::Vector2f>) {
+            return func(d1.position, d1.size, d2.position, d2.size);
+        } else if constexpr (std::is_invocable_v<CollisionFunc, sf::Vector2f, sf::Vector2f, float, sf::FloatRect, sf::Vector2f>) {
+            if (!cachedRaycastResult.counter) {
+                return func(d1.position, d1.direction, d1.speed, d1.bounds, d1.acceleration,
+                            d2.position, d2.direction, d2.speed, d2.bounds, d2.acceleration);
+            } else if (timeElapsed > cachedRaycastResult.collisionTimes[counterIndex]) {
+                cachedRaycastResult.counter = 0;
+                return true;
+            }
+        } else if constexpr (std::is_invocable_v<CollisionFunc, std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f,
+                                                                std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f>) {
+            return func(d1.bitmask, d1.position, d1.size, d2.bitmask, d2.position, d2.size);
+        }
+        return false;
+    }
+
+    // sprite vs sprite args: the collision function, then optionally a Quadtree*, time elapsed and counter index.
+    // The tree answers with the bounds of its last update(), so run quadtree.update() after the sprites move and
+    // before checking, a sprite that moved since can be missed
     template<typename ObjType1, typename ObjType2, typename... Args>
     bool collisionHelper(ObjType1&& obj1, ObjType2&& obj2, Args&&... args) {
         auto getSprite = [](auto&& obj) -> auto& {
@@ -235,44 +261,57 @@ namespace physics{
                 counterIndex = std::get<3>(std::forward_as_tuple(std::forward<Args>(args)...));
             }
 
-            auto collisionLambda = [&timeElapsed, counterIndex](const CollisionData& d1, const CollisionData& d2, auto&& func) {
-                if constexpr (std::is_invocable_v<decltype(func), sf::Vector2f, float, sf::Vector2f, float>) {
-                    return func(d1.position, d1.radius, d2.position, d2.radius);
-                } else if constexpr (std::is_invocable_v<decltype(func), sf::Vector2f, sf::Vector2f, sf::Vector2f, sf::Vector2f>) {
-                    return func(d1.position, d1.size, d2.position, d2.size);
-                } else if constexpr (std::is_invocable_v<decltype(func), sf::Vector2f, sf::Vector2f, float, sf::FloatRect, sf::Vector2f>) {
-                    if (!cachedRaycastResult.counter) {
-                        return func(d1.position, d1.direction, d1.speed, d1.bounds, d1.acceleration,
-                                    d2.position, d2.direction, d2.speed, d2.bounds, d2.acceleration);
-                    } else if (timeElapsed > cachedRaycastResult.collisionTimes[counterIndex]) {
-                        cachedRaycastResult.counter = 0;
-                        return true;
-                    }
-                } else if constexpr (std::is_invocable_v<decltype(func), std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f,
-                                                                        std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f>) {
-                    return func(d1.bitmask, d1.position, d1.size, d2.bitmask, d2.position, d2.size);
+            if (quadtree) { // the tree is the broad phase, the pair only goes on if it reports sprite2 near sprite1. needs a fresh update()
+                const Sprite* other = &*sprite2;
+                bool candidate = false;
+                quadtree->forEachIn(data1.bounds, [&candidate, other](Sprite* nearby) { candidate = candidate || nearby == other; });
+                if (!candidate) return false;
+            }
+            return narrowPhase(data1, data2, collisionFunc, timeElapsed, counterIndex);
+        }
+    }
+
+    // Sort and sweep broad phase over sprites (see SweepAndPrune), every candidate pair once per call.
+    // Library only for now: the scenes have no sprite vs sprite checks, pawns block each other through the board tiles
+    class BroadPhase {
+    public:
+        using Pair = SweepAndPrune::Pair;
+
+        const std::vector<Pair>& findPairs(const std::vector<sf::FloatRect>& boxes) { return sweep.findPairs(boxes); }
+
+        // broad phase over the sprites' bounds, then the narrow phase once per candidate pair.
+        // onHit(i, j) for every pair that collides, i < j index sprites. Returns the number of hits
+        template<typename SpritePtr, typename CollisionFunc, typename OnHit>
+        size_t collide(const std::vector<SpritePtr>& sprites, CollisionFunc&& collisionFunc, OnHit&& onHit) {
+            boxes.clear();
+            for (const auto& sprite : sprites) boxes.push_back(sprite->returnSpritesShape().getGlobalBounds());
+            const std::vector<Pair>& candidates = findPairs(boxes);
+
+            // narrow phase data is only gathered for sprites that made it into a pair, once each
+            data.resize(sprites.size());
+            extracted.assign(sprites.size(), 0);
+            auto dataOf = [this, &sprites](uint32_t index) -> const CollisionData& {
+                if (!extracted[index]) {
+                    data[index] = extractCollisionData(sprites[index]);
+                    extracted[index] = 1;
                 }
-                return false;
+                return data[index];
             };
 
-            if (quadtree) {
-                auto potentialColliders1 = quadtree->query(sprite1->returnSpritesShape().getGlobalBounds());
-                auto potentialColliders2 = quadtree->query(sprite2->returnSpritesShape().getGlobalBounds());
-
-                if (potentialColliders1.empty() || potentialColliders2.empty()) return false;
-
-                for (const auto& collider1 : potentialColliders1) {
-                    for (const auto& collider2 : potentialColliders2) {
-                        if (collider1 == collider2) continue;
-                        if (collisionLambda(data1, data2, collisionFunc)) {
-                            return true;
-                        }
-                    }
+            size_t hits = 0;
+            for (const Pair& pair : candidates) {
+                if (narrowPhase(dataOf(pair.first), dataOf(pair.second), collisionFunc)) {
+                    onHit(pair.first, pair.second);
+                    ++hits;
                 }
-                return false;
-            } else {
-                return collisionLambda(data1, data2, collisionFunc);
             }
+            return hits;
         }
-    }
+
+    private:
+        SweepAndPrune sweep;
+        std::vector<sf::FloatRect> boxes;
+        std::vector<CollisionData> data;
+        std::vector<uint8_t> extracted;
+    };
 }    
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "quadtree.hpp"
+
+#include <algorithm>
+
+namespace physics {
+    Quadtree::Quadtree(float x, float y, float width, float height, size_t level, size_t maxObjects, size_t maxLevels)
+        : maxObjects(std::max<size_t>(1, maxObjects)), maxLevels(std::min(maxLevels, MAX_LEVELS)) {
+        Node root;
+        root.bounds = sf::FloatRect(x, y, width, height);
+        root.level = static_cast<uint32_t>(std::min(level, this->maxLevels));
+        nodes.push_back(root);
+    }
+
+    void Quadtree::clear() {
+        nodes.resize(1); // keeps the capacity for the next build
+        nodes[0].firstChild = NONE;
+        nodes[0].firstItem = NONE;
+        nodes[0].count = 0;
+        nodes[0].subtreeCount = 0;
+        items.clear();
+        freeItem = NONE;
+        freeBlock = NONE;
+        itemCount = 0;
+        liveNodes = 1;
+    }
+
+    Quadtree::Handle Quadtree::insert(Sprite* sprite, const sf::FloatRect& bounds) {
+        if (!sprite) return NONE;
+        Handle handle;
+        if (freeItem != NONE) {
+            handle = freeItem;
+            freeItem = items[handle].next;
+        } else {
+            handle = static_cast<Handle>(items.size());
+            items.emplace_back();
+        }
+        items[handle].sprite = sprite;
+        items[handle].bounds = bounds;
+        place(handle, 0);
+        ++itemCount;
+        return handle;
+    }
+
+    void Quadtree::remove(Handle handle) {
+        if (handle < 0 || handle >= static_cast<Handle>(items.size()) || !items[handle].sprite) return;
+        int32_t node = items[handle].node;
+        unlink(handle);
+        items[handle].sprite = nullptr;
+        items[handle].next = freeItem;
+        freeItem = handle;
+        --itemCount;
+        mergeAbove(node);
+    }
+
+    void Quadtree::move(Handle handle, const sf::FloatRect& bounds) {
+        if (handle < 0 || handle >= static_cast<Handle>(items.size()) || !items[handle].sprite) return;
+        Item& item = items[handle];
+        item.bounds = bounds;
+        int32_t node = item.node;
+        if (holds(node, bounds) && (nodes[node].firstChild == NONE || childFor(nodes[node], bounds) == NONE)) return; // still the right node
+
+        // climb to the nearest node that holds the new bounds and go down from there
+        unlink(handle);
+        int32_t start = node;
+        while (!holds(start, bounds)) start = nodes[start].parent;
+        place(handle, start);
+        mergeAbove(node);
+    }
+
+    void Quadtree::query(const sf::FloatRect& area, std::vector<Sprite*>& result) const {
+        forEachIn(area, [&result](Sprite* sprite) { result.push_back(sprite); });
+    }
+
+    bool Quadtree::holds(int32_t node, const sf::FloatRect& bounds) const {
+        if (node == 0) return true;
+        const sf::FloatRect& area = nodes[node].bounds;
+        return bounds.left >= area.left && bounds.top >= area.top &&
+               bounds.left + bounds.width <= area.left + area.width && bounds.top + bounds.height <= area.top + area.height;
+    }
+
+    int32_t Quadtree::childFor(const Node& node, const sf::FloatRect& bounds) const {
+        float midX = node.bounds.left + node.bounds.width * 0.5f;
+        float midY = node.bounds.top + node.bounds.height * 0.5f;
+        bool left = bounds.left + bounds.width <= midX;
+        bool right = bounds.left >= midX;
+        bool upper = bounds.top + bounds.height <= midY;
+        bool lower = bounds.top >= midY;
+        if (!(left || right) || !(upper || lower)) return NONE; // straddles a split line, stays in this node
+        int32_t child = node.firstChild + (right ? 1 : 0) + (lower ? 2 : 0);
+        return holds(child, bounds) ? child : NONE; // the root's children don't reach past the world
+    }
+
+    void Quadtree::link(int32_t item, int32_t node) {
+        Node& target = nodes[node];
+        items[item].node = node;
+        items[item].prev = NONE;
+        items[item].next = target.firstItem;
+        if (target.firstItem != NONE) items[target.firstItem].prev = item;
+        target.firstItem = item;
+        ++target.count;
+        for (int32_t i = node; i != NONE; i = nodes[i].parent) ++nodes[i].subtreeCount;
+    }
+
+    void Quadtree::unlink(int32_t item) {
+        Item& entry = items[item];
+        Node& source = nodes[entry.node];
+        if (entry.prev != NONE) items[entry.prev].next = entry.next;
+        else source.firstItem = entry.next;
+        if (entry.next != NONE) items[entry.next].prev = entry.prev;
+        --source.count;
+        for (int32_t i = entry.node; i != NONE; i = nodes[i].parent) --nodes[i].subtreeCount;
+        entry.node = NONE;
+    }
+
+    void Quadtree::place(int32_t item, int32_t node) {
+        while (nodes[node].firstChild != NONE) {
+            int32_t child = childFor(nodes[node], items[item].bounds);
+            if (child == NONE) break;
+            node = child;
+        }
+        link(item, node);
+        if (nodes[node].firstChild == NONE && nodes[node].count > maxObjects && nodes[node].level < maxLevels) split(node);
+    }
+
+    void Quadtree::split(int32_t index) {
+        int32_t firstChild;
+        if (freeBlock != NONE) {
+            firstChild = freeBlock;
+            freeBlock = nodes[freeBlock].firstChild;
+        } else {
+            firstChild = static_cast<int32_t>(nodes.size());
+            nodes.resize(nodes.size() + 4); // may move the pool, everything below goes through indices
+        }
+        liveNodes += 4;
+
+        sf::FloatRect bounds = nodes[index].bounds;
+        float halfWidth = bounds.width * 0.5f;
+        float halfHeight = bounds.height * 0.5f;
+        for (int32_t child = 0; child < 4; ++child) { // top left, top right, bottom left, bottom right
+            Node& node = nodes[firstChild + child];
+            node = Node();
+            node.bounds = sf::FloatRect(bounds.left + (child & 1) * halfWidth, bounds.top + (child >> 1) * halfHeight, halfWidth, halfHeight);
+            node.parent = index;
+            node.level = nodes[index].level + 1;
+        }
+        nodes[index].firstChild = firstChild;
+
+        // hand down whatever fits a quadrant, the subtree totals above don't change
+        int32_t item = nodes[index].firstItem;
+        while (item != NONE) {
+            int32_t next = items[item].next;
+            int32_t child = childFor(nodes[index], items[item].bounds);
+            if (child != NONE) {
+                unlink(item);
+                link(item, child);
+            }
+            item = next;
+        }
+        for (int32_t child = firstChild; child < firstChild + 4; ++child) { // everything may have landed in one quadrant
+            if (nodes[child].count > maxObjects && nodes[child].level < maxLevels) split(child);
+        }
+    }
+
+    void Quadtree::mergeAbove(int32_t node) {
+        int32_t highest = NONE;
+        for (int32_t i = nodes[node].firstChild == NONE ? nodes[node].parent : node; i != NONE; i = nodes[i].parent) {
+            if (nodes[i].subtreeCount <= maxObjects / 2) highest = i; // half of the split threshold, so a border case can't flap
+        }
+        if (highest != NONE) collapse(highest);
+    }
+
+    void Quadtree::collapse(int32_t index) {
+        std::array<int32_t, 4 * MAX_LEVELS> blocks; // child blocks still to empty, depth first
+        size_t top = 0;
+        blocks[top++] = nodes[index].firstChild;
+        nodes[index].firstChild = NONE;
+        while (top) {
+            int32_t block = blocks[--top];
+            for (int32_t child = block; child < block + 4; ++child) {
+                while (nodes[child].firstItem != NONE) { // counts above index stay the same, it already included these
+                    int32_t item = nodes[child].firstItem;
+                    nodes[child].firstItem = items[item].next;
+                    Node& target = nodes[index];
+                    items[item].node = index;
+                    items[item].prev = NONE;
+                    items[item].next = target.firstItem;
+                    if (target.firstItem != NONE) items[target.firstItem].prev = item;
+                    target.firstItem = item;
+                    ++target.count;
+                }
+                if (nodes[child].firstChild != NONE) blocks[top++] = nodes[child].firstChild;
+            }
+            nodes[block].firstChild = freeBlock;
+            freeBlock = block;
+            liveNodes -= 4;
+        }
+    }
+}
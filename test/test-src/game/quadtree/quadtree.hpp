@@ -0,0 +1,111 @@
+//
+//  quadtree.hpp
+//
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <SFML/Graphics/Rect.hpp>
+
+class Sprite; // stored and handed back, never touched in here
+
+// Spatial index for the physics broad phase, it only ever sees the bounds handed to insert, move and update
+namespace physics {
+    // Linear quadtree: nodes sit in one pool and the four children of a node are consecutive, found by index.
+    // Objects are per node linked lists in a second pool and each one remembers its node, so a move only relinks
+    // when the bounds leave that node or fit one of its children. Leaves split past maxObjects and a subtree folds
+    // back into its root once it holds half that. Freed nodes and objects are reused, nothing is returned to the heap
+    class Quadtree {
+    public:
+        using Handle = int32_t; // an object's slot, valid until it's removed or the tree is cleared
+        static constexpr Handle NONE = -1;
+        static constexpr size_t MAX_LEVELS = 16; // bounds the traversal stacks
+
+        Quadtree(float x, float y, float width, float height, size_t level = 0, size_t maxObjects = 10, size_t maxLevels = 5);
+        void clear();
+
+        Handle insert(Sprite* sprite, const sf::FloatRect& bounds);
+        template<typename SpriteType> Handle insert(std::unique_ptr<SpriteType>& obj) {
+            return obj ? insert(static_cast<Sprite*>(obj.get()), obj->returnSpritesShape().getGlobalBounds()) : NONE;
+        }
+        void remove(Handle handle);
+        void move(Handle handle, const sf::FloatRect& bounds);
+
+        void update(); // moves every object to its sprite's current bounds, defined with the sprites in physics.cpp
+        template<typename BoundsOf> void update(BoundsOf&& boundsOf); // boundsOf(Sprite*) -> sf::FloatRect
+
+        void query(const sf::FloatRect& area, std::vector<Sprite*>& result) const; // appends, reuse result across calls
+        template<typename Visitor> void forEachIn(const sf::FloatRect& area, Visitor&& visit) const; // visit(Sprite*)
+
+        size_t size() const { return itemCount; }
+        size_t getNodeCount() const { return liveNodes; }
+
+    private:
+        struct Node {
+            sf::FloatRect bounds;
+            int32_t parent = NONE;
+            int32_t firstChild = NONE; // children at firstChild .. firstChild + 3, next free block while freed
+            int32_t firstItem = NONE;
+            uint32_t count = 0; // objects in this node
+            uint32_t subtreeCount = 0; // objects in this node and below
+            uint32_t level = 0;
+        };
+        struct Item {
+            Sprite* sprite = nullptr; // null while on the free list
+            sf::FloatRect bounds;
+            int32_t node = NONE;
+            int32_t prev = NONE;
+            int32_t next = NONE; // next free slot while freed
+        };
+
+        bool holds(int32_t node, const sf::FloatRect& bounds) const; // the root holds anything, it keeps what sticks out
+        int32_t childFor(const Node& node, const sf::FloatRect& bounds) const; // the child holding bounds whole, or NONE
+        void link(int32_t item, int32_t node);
+        void unlink(int32_t item);
+        void place(int32_t item, int32_t node); // deepest node under node that holds the item
+        void split(int32_t node);
+        void mergeAbove(int32_t node); // folds the highest ancestor that went under the merge threshold
+        void collapse(int32_t node);
+
+        size_t maxObjects;
+        size_t maxLevels;
+        std::vector<Node> nodes; // [0] is the root
+        std::vector<Item> items;
+        int32_t freeItem = NONE;
+        int32_t freeBlock = NONE;
+        size_t itemCount = 0;
+        size_t liveNodes = 1;
+    };
+
+    template<typename BoundsOf>
+    void Quadtree::update(BoundsOf&& boundsOf) {
+        for (Handle handle = 0; handle < static_cast<Handle>(items.size()); ++handle) {
+            if (!items[handle].sprite) continue;
+            sf::FloatRect bounds = boundsOf(items[handle].sprite);
+            if (bounds != items[handle].bounds) move(handle, bounds);
+        }
+    }
+
+    template<typename Visitor>
+    void Quadtree::forEachIn(const sf::FloatRect& area, Visitor&& visit) const {
+        std::array<int32_t, 3 * MAX_LEVELS + 1> stack; // depth first, each level leaves at most three siblings behind
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            int32_t index = stack[--top];
+            const Node& node = nodes[index];
+            if (node.subtreeCount == 0 || (index != 0 && !node.bounds.intersects(area))) continue;
+            for (int32_t i = node.firstItem; i != NONE; i = items[i].next) {
+                if (area.intersects(items[i].bounds)) visit(items[i].sprite);
+            }
+            if (node.firstChild != NONE) {
+                for (int32_t child = 0; child < 4; ++child) stack[top++] = node.firstChild + child;
+            }
+        }
+    }
+}
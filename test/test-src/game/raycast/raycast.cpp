@@ -0,0 +1,234 @@
+#include "raycast.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RAYCAST_X86 1
+#define RAYCAST_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace raycast {
+    namespace {
+        std::atomic<KernelPath> activePath { detectKernelPath() };
+
+        bool isSupported(KernelPath path) {
+            return static_cast<int>(path) <= static_cast<int>(detectKernelPath());
+        }
+
+        // ray direction = offset direction turned by the heading, no trig per ray
+        void computeDirectionsScalar(RayFan& fan, float cosHeading, float sinHeading, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fan.dirX[i] = cosHeading * fan.fishEye[i] - sinHeading * fan.offsetSin[i];
+                fan.dirY[i] = sinHeading * fan.fishEye[i] + cosHeading * fan.offsetSin[i];
+            }
+        }
+
+        void projectWallsScalar(RayFan& fan, const WallProjection& projection, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                float corrected = std::max(1.0f, fan.distance[i] * fan.fishEye[i]);
+                float wallHeight = projection.wallHeightScale / corrected * fan.hit[i];
+                fan.top[i] = projection.centerY - wallHeight * 0.5f;
+                fan.bottom[i] = projection.centerY + wallHeight * 0.5f;
+                fan.shade[i] = std::min(SHADE_LEVELS - 1, static_cast<int>((corrected / projection.maxDistance) * SHADE_LEVELS));
+                fan.depth[i] = fan.hit[i] != 0.0f ? corrected : std::numeric_limits<float>::infinity();
+            }
+        }
+
+#ifdef RAYCAST_X86
+        void computeDirectionsSSE(RayFan& fan, float cosHeading, float sinHeading, size_t begin, size_t end) {
+            __m128 c = _mm_set1_ps(cosHeading);
+            __m128 s = _mm_set1_ps(sinHeading);
+            for (size_t i = begin; i < end; i += 4) {
+                __m128 offsetCos = _mm_loadu_ps(&fan.fishEye[i]);
+                __m128 offsetSin = _mm_loadu_ps(&fan.offsetSin[i]);
+                _mm_storeu_ps(&fan.dirX[i], _mm_sub_ps(_mm_mul_ps(c, offsetCos), _mm_mul_ps(s, offsetSin)));
+                _mm_storeu_ps(&fan.dirY[i], _mm_add_ps(_mm_mul_ps(s, offsetCos), _mm_mul_ps(c, offsetSin)));
+            }
+        }
+
+        void projectWallsSSE(RayFan& fan, const WallProjection& projection, size_t begin, size_t end) {
+            __m128 one = _mm_set1_ps(1.0f);
+            __m128 scale = _mm_set1_ps(projection.wallHeightScale);
+            __m128 centerY = _mm_set1_ps(projection.centerY);
+            __m128 half = _mm_set1_ps(0.5f);
+            __m128 maxDistance = _mm_set1_ps(projection.maxDistance);
+            __m128 levels = _mm_set1_ps(static_cast<float>(SHADE_LEVELS));
+            __m128i lastLevel = _mm_set1_epi32(SHADE_LEVELS - 1);
+            __m128 zero = _mm_setzero_ps();
+            __m128 far = _mm_set1_ps(std::numeric_limits<float>::infinity());
+            for (size_t i = begin; i < end; i += 4) {
+                __m128 corrected = _mm_max_ps(one, _mm_mul_ps(_mm_loadu_ps(&fan.distance[i]), _mm_loadu_ps(&fan.fishEye[i])));
+                __m128 hit = _mm_loadu_ps(&fan.hit[i]);
+                __m128 wallHeight = _mm_mul_ps(_mm_div_ps(scale, corrected), hit);
+                __m128 missed = _mm_cmpeq_ps(hit, zero);
+                _mm_storeu_ps(&fan.depth[i], _mm_or_ps(_mm_andnot_ps(missed, corrected), _mm_and_ps(missed, far)));
+                __m128 halfHeight = _mm_mul_ps(wallHeight, half);
+                _mm_storeu_ps(&fan.top[i], _mm_sub_ps(centerY, halfHeight));
+                _mm_storeu_ps(&fan.bottom[i], _mm_add_ps(centerY, halfHeight));
+
+                __m128i shade = _mm_cvttps_epi32(_mm_mul_ps(_mm_div_ps(corrected, maxDistance), levels));
+                shade = _mm_xor_si128(shade, _mm_and_si128(_mm_xor_si128(shade, lastLevel), _mm_cmpgt_epi32(shade, lastLevel))); // min, SSE2 has no _mm_min_epi32
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&fan.shade[i]), shade);
+            }
+        }
+
+        RAYCAST_AVX2 void computeDirectionsAVX2(RayFan& fan, float cosHeading, float sinHeading, size_t begin, size_t end) {
+            __m256 c = _mm256_set1_ps(cosHeading);
+            __m256 s = _mm256_set1_ps(sinHeading);
+            for (size_t i = begin; i < end; i += 8) {
+                __m256 offsetCos = _mm256_loadu_ps(&fan.fishEye[i]);
+                __m256 offsetSin = _mm256_loadu_ps(&fan.offsetSin[i]);
+                _mm256_storeu_ps(&fan.dirX[i], _mm256_sub_ps(_mm256_mul_ps(c, offsetCos), _mm256_mul_ps(s, offsetSin)));
+                _mm256_storeu_ps(&fan.dirY[i], _mm256_add_ps(_mm256_mul_ps(s, offsetCos), _mm256_mul_ps(c, offsetSin)));
+            }
+        }
+
+        RAYCAST_AVX2 void projectWallsAVX2(RayFan& fan, const WallProjection& projection, size_t begin, size_t end) {
+            __m256 one = _mm256_set1_ps(1.0f);
+            __m256 scale = _mm256_set1_ps(projection.wallHeightScale);
+            __m256 centerY = _mm256_set1_ps(projection.centerY);
+            __m256 half = _mm256_set1_ps(0.5f);
+            __m256 maxDistance = _mm256_set1_ps(projection.maxDistance);
+            __m256 levels = _mm256_set1_ps(static_cast<float>(SHADE_LEVELS));
+            __m256i lastLevel = _mm256_set1_epi32(SHADE_LEVELS - 1);
+            __m256 zero = _mm256_setzero_ps();
+            __m256 far = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+            for (size_t i = begin; i < end; i += 8) {
+                __m256 corrected = _mm256_max_ps(one, _mm256_mul_ps(_mm256_loadu_ps(&fan.distance[i]), _mm256_loadu_ps(&fan.fishEye[i])));
+                __m256 hit = _mm256_loadu_ps(&fan.hit[i]);
+                __m256 wallHeight = _mm256_mul_ps(_mm256_div_ps(scale, corrected), hit);
+                _mm256_storeu_ps(&fan.depth[i], _mm256_blendv_ps(corrected, far, _mm256_cmp_ps(hit, zero, _CMP_EQ_OQ)));
+                __m256 halfHeight = _mm256_mul_ps(wallHeight, half);
+                _mm256_storeu_ps(&fan.top[i], _mm256_sub_ps(centerY, halfHeight));
+                _mm256_storeu_ps(&fan.bottom[i], _mm256_add_ps(centerY, halfHeight));
+
+                __m256i shade = _mm256_min_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(_mm256_div_ps(corrected, maxDistance), levels)), lastLevel);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&fan.shade[i]), shade);
+            }
+        }
+#endif
+    }
+
+    KernelPath detectKernelPath() {
+#ifdef RAYCAST_X86
+        static const KernelPath detected = [] {
+            __builtin_cpu_init(); // may run from a static initializer, before the runtime has filled in the cpu model
+            return __builtin_cpu_supports("avx2") ? KernelPath::AVX2 : KernelPath::SSE;
+        }();
+        return detected;
+#else
+        return KernelPath::SCALAR;
+#endif
+    }
+
+    KernelPath getActivePath() { return activePath.load(std::memory_order_relaxed); }
+
+    void setActivePath(KernelPath path) {
+        if (isSupported(path)) activePath.store(path, std::memory_order_relaxed);
+    }
+
+    const char* getKernelPathName(KernelPath path) {
+        switch (path) {
+            case KernelPath::AVX2: return "avx2";
+            case KernelPath::SSE: return "sse";
+            default: return "scalar";
+        }
+    }
+
+    void RayFan::resize(size_t rays) {
+        count = rays;
+        size_t padded = (rays + PACKET_WIDTH - 1) / PACKET_WIDTH * PACKET_WIDTH; // packets may run past count, never past the buffer
+        for (std::vector<float>* field : { &dirX, &dirY, &fishEye, &offsetSin, &distance, &hit, &top, &bottom, &depth }) field->resize(padded, 0.0f);
+        side.resize(padded, 0);
+        shade.resize(padded, 0);
+    }
+
+    void buildOffsetTable(RayFan& fan, float angleStep) {
+        if (fan.tableCount == fan.count && fan.tableStep == angleStep) return;
+        for (size_t i = 0; i < fan.fishEye.size(); ++i) { // padding too, so packets past count stay finite
+            double offset = (i - fan.count * 0.5) * angleStep;
+            fan.fishEye[i] = static_cast<float>(std::cos(offset));
+            fan.offsetSin[i] = static_cast<float>(std::sin(offset));
+        }
+        fan.tableCount = fan.count;
+        fan.tableStep = angleStep;
+    }
+
+    float snapHeading(float headingDegrees, float stepDegrees) {
+        float heading = std::fmod(headingDegrees, 360.0f);
+        if (heading < 0.0f) heading += 360.0f;
+        if (!(stepDegrees > 0.0f)) return heading;
+        return std::round(heading / stepDegrees) * stepDegrees;
+    }
+
+    bool getLatticeShift(float fromDegrees, float toDegrees, float stepDegrees, size_t rayCount, long& shift) {
+        if (!(stepDegrees > 0.0f)) return false;
+        float steps = std::remainder(toDegrees - fromDegrees, 360.0f) / stepDegrees;
+        float wholeSteps = std::round(steps);
+        if (std::abs(steps - wholeSteps) > 1e-3f || std::abs(wholeSteps) >= static_cast<float>(rayCount)) return false;
+        shift = static_cast<long>(wholeSteps);
+        return true;
+    }
+
+    void computeDirections(RayFan& fan, float heading, float angleStep, KernelPath path) {
+        buildOffsetTable(fan, angleStep);
+        computeDirections(fan, heading, 0, fan.count, path);
+    }
+
+    void computeDirections(RayFan& fan, float heading, size_t begin, size_t end, KernelPath path) {
+        if (!isSupported(path)) path = detectKernelPath();
+        end = std::min(end, fan.count);
+        if (begin >= end) return;
+        float cosHeading = std::cos(heading);
+        float sinHeading = std::sin(heading);
+#ifdef RAYCAST_X86
+        if (path == KernelPath::AVX2) return computeDirectionsAVX2(fan, cosHeading, sinHeading, begin, end);
+        if (path == KernelPath::SSE) return computeDirectionsSSE(fan, cosHeading, sinHeading, begin, end);
+#endif
+        computeDirectionsScalar(fan, cosHeading, sinHeading, begin, end);
+    }
+
+    void projectWalls(RayFan& fan, const WallProjection& projection, sf::Vertex* out, KernelPath path) {
+        projectWalls(fan, projection, out, 0, fan.count, path);
+    }
+
+    void projectWalls(RayFan& fan, const WallProjection& projection, sf::Vertex* out, size_t begin, size_t end, KernelPath path) {
+        if (!isSupported(path)) path = detectKernelPath();
+        end = std::min(end, fan.count);
+        if (begin >= end) return;
+#ifdef RAYCAST_X86
+        if (path == KernelPath::AVX2) projectWallsAVX2(fan, projection, begin, end);
+        else if (path == KernelPath::SSE) projectWallsSSE(fan, projection, begin, end);
+        else projectWallsScalar(fan, projection, begin, end);
+#else
+        projectWallsScalar(fan, projection, begin, end);
+#endif
+
+        // quads straight into the caller's buffer, a miss leaves a zero height slice.
+        // locals so the vertex stores can't force the fan's buffers to be reloaded every ray
+        const float* top = fan.top.data();
+        const float* bottom = fan.bottom.data();
+        const int32_t* side = fan.side.data();
+        const int32_t* shade = fan.shade.data();
+        const float sliceWidth = projection.sliceWidth;
+        const sf::Color* shades[2] = { projection.shades[0], projection.shades[1] };
+        for (size_t i = begin; i < end; ++i) {
+            float left = i * sliceWidth;
+            float right = left + sliceWidth;
+            sf::Color color = shades[side[i]][shade[i]];
+            sf::Vertex* quad = out + 4 * i;
+            quad[0].position = sf::Vector2f(left, top[i]);
+            quad[1].position = sf::Vector2f(right, top[i]);
+            quad[2].position = sf::Vector2f(right, bottom[i]);
+            quad[3].position = sf::Vector2f(left, bottom[i]);
+            quad[0].color = color;
+            quad[1].color = color;
+            quad[2].color = color;
+            quad[3].color = color;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  raycast.hpp
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+// Per-ray math of the first person wall view, a packet of rays at a time. The grid traversal stays in physics,
+// this turns the heading into ray directions and the hit distances into wall quads.
+namespace raycast {
+    enum class KernelPath { SCALAR, SSE, AVX2 };
+    KernelPath detectKernelPath(); // widest path this CPU runs, checked once
+    KernelPath getActivePath(); // detected path unless overridden, used by default
+    void setActivePath(KernelPath path); // benchmarks and debugging, ignored if the CPU can't run it
+    const char* getKernelPathName(KernelPath path);
+
+    constexpr size_t PACKET_WIDTH = 8; // widest packet, fan buffers are padded to a multiple of it
+    constexpr int SHADE_LEVELS = 256;
+
+    // structure of arrays so a packet is one load per field
+    struct RayFan {
+        size_t count = 0;
+        std::vector<float> dirX;
+        std::vector<float> dirY;
+        std::vector<float> fishEye; // cos of the angle between ray and heading
+        std::vector<float> offsetSin; // sin of that angle, with fishEye the ray's direction at heading 0
+        size_t tableCount = 0; // fan size and spacing the offset table was built for
+        float tableStep = 0.0f;
+
+        // traversal results, written by the caller between computeDirections and projectWalls
+        std::vector<float> distance;
+        std::vector<float> hit; // 1 if the ray hit a wall, 0 draws an empty slice
+        std::vector<int32_t> side; // 0 east/west face, 1 north/south face
+
+        // projection results
+        std::vector<float> top;
+        std::vector<float> bottom;
+        std::vector<int32_t> shade; // brightness table index
+        std::vector<float> depth; // fish-eye corrected wall distance per column, infinity where the ray missed. sprites clip against it
+
+        void resize(size_t rays); // keeps capacity, safe to call every frame
+    };
+
+    struct WallProjection {
+        float sliceWidth = 1.0f;
+        float centerY = 0.0f;
+        float wallHeightScale = 2500.0f;
+        float maxDistance = 100.0f; // distance of the darkest shade
+        const sf::Color* shades[2] = { nullptr, nullptr }; // SHADE_LEVELS colors per face
+    };
+
+    // per ray offsets from the heading, rebuilt only when the ray count or spacing (FOV, rays_num) changed.
+    // the range overload below expects it done, call it before handing ranges to other threads
+    void buildOffsetTable(RayFan& fan, float angleStep);
+
+    // count rays centred on heading (radians), angleStep apart, same spacing as the original fan.
+    // one rotation of the offset table per call, no trig per ray
+    void computeDirections(RayFan& fan, float heading, float angleStep, KernelPath path = getActivePath());
+
+    // ranges let several threads share one fan, begin must be a multiple of PACKET_WIDTH so packets never overlap
+    void computeDirections(RayFan& fan, float heading, size_t begin, size_t end, KernelPath path = getActivePath());
+
+    // Rays sit on a lattice of world angles: the heading snaps to a whole multiple of the ray step, so a turn of any size
+    // lands every ray on some ray's old angle and the rays still in view keep their hits. At most half a step off
+    float snapHeading(float headingDegrees, float stepDegrees); // degrees, [0, 360]
+    // whole ray steps from one snapped heading to another, positive turns right. false when there is nothing to keep:
+    // the turn left the fan, or crossed 0 with a step that doesn't divide 360
+    bool getLatticeShift(float fromDegrees, float toDegrees, float stepDegrees, size_t rayCount, long& shift);
+
+    // slice heights and shades from the fan's distances, then 4 quad vertices per ray into out (4 * count vertices)
+    void projectWalls(RayFan& fan, const WallProjection& projection, sf::Vertex* out, KernelPath path = getActivePath());
+    void projectWalls(RayFan& fan, const WallProjection& projection, sf::Vertex* out, size_t begin, size_t end, KernelPath path = getActivePath());
+}
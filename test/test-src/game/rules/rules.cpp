@@ -0,0 +1,504 @@
+#include "rules.hpp"
+
+#include <algorithm>
+
+namespace rules {
+    namespace {
+        constexpr uint64_t WALL_COL0 = 0x0101010101010101ULL; // slot column 0 of every slot row
+        constexpr uint64_t WALL_COL7 = 0x8080808080808080ULL; // slot column 7 of every slot row
+
+        Bitboard buildColumnMask(int col) {
+            Bitboard mask = 0;
+            for (int row = 0; row < BOARD_SIZE; ++row) mask |= cellBit(cellIndex(row, col));
+            return mask;
+        }
+
+        Bitboard buildRowMask(int row) {
+            Bitboard mask = 0;
+            for (int col = 0; col < BOARD_SIZE; ++col) mask |= cellBit(cellIndex(row, col));
+            return mask;
+        }
+
+        const Bitboard ALL_CELLS = (Bitboard(1) << CELL_COUNT) - 1;
+        const Bitboard EAST_EDGE = buildColumnMask(BOARD_SIZE - 1);
+        const Bitboard SOUTH_EDGE = buildRowMask(BOARD_SIZE - 1);
+
+        bool testBit(uint64_t bits, int row, int col) {
+            if (row < 0 || row >= WALL_SIZE || col < 0 || col >= WALL_SIZE) return false;
+            return (bits >> slotIndex(row, col)) & 1ULL;
+        }
+
+        // the two cell pairs a wall slot separates
+        std::array<std::array<int, 2>, 2> wallEdges(MoveType orientation, int slot) {
+            int row = slot / WALL_SIZE, col = slot % WALL_SIZE;
+            if (orientation == MoveType::HORIZONTAL_WALL) {
+                return {{ { cellIndex(row, col), cellIndex(row + 1, col) }, { cellIndex(row, col + 1), cellIndex(row + 1, col + 1) } }};
+            }
+            return {{ { cellIndex(row, col), cellIndex(row, col + 1) }, { cellIndex(row + 1, col), cellIndex(row + 1, col + 1) } }};
+        }
+    }
+
+    namespace {
+        struct ZobristKeys {
+            std::array<std::array<uint64_t, CELL_COUNT>, 2> pawns {};
+            std::array<std::array<uint64_t, SLOT_COUNT>, 2> walls {};
+            std::array<std::array<uint64_t, WALLS_PER_SIDE + 1>, 2> wallsLeft {};
+            uint64_t sideToMove = 0;
+
+            ZobristKeys() {
+                uint64_t state = 0x9E3779B97F4A7C15ULL;
+                auto next = [&state]() { // splitmix64
+                    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                    return z ^ (z >> 31);
+                };
+                for (auto& side : pawns) for (uint64_t& key : side) key = next();
+                for (auto& orientation : walls) for (uint64_t& key : orientation) key = next();
+                for (auto& side : wallsLeft) for (uint64_t& key : side) key = next();
+                sideToMove = next();
+            }
+        };
+
+        const ZobristKeys& zobrist() {
+            static const ZobristKeys keys;
+            return keys;
+        }
+    }
+
+    uint64_t pawnKey(Side side, int cell) { return zobrist().pawns[static_cast<int>(side)][cell]; }
+    uint64_t wallKey(MoveType orientation, int slot) { return zobrist().walls[orientation == MoveType::HORIZONTAL_WALL ? 0 : 1][slot]; }
+    uint64_t wallsLeftKey(Side side, int count) { return zobrist().wallsLeft[static_cast<int>(side)][count]; }
+    uint64_t sideToMoveKey() { return zobrist().sideToMove; }
+
+    int lowestCell(Bitboard cells) {
+        uint64_t low = static_cast<uint64_t>(cells);
+        if (low) return __builtin_ctzll(low);
+        return 64 + __builtin_ctzll(static_cast<uint64_t>(cells >> 64));
+    }
+
+    int neighbourCell(int cell, Direction direction) {
+        int row = cellRow(cell), col = cellCol(cell);
+        switch (direction) {
+            case NORTH: return row > 0 ? cell - BOARD_SIZE : -1;
+            case EAST: return col < BOARD_SIZE - 1 ? cell + 1 : -1;
+            case SOUTH: return row < BOARD_SIZE - 1 ? cell + BOARD_SIZE : -1;
+            case WEST: return col > 0 ? cell - 1 : -1;
+        }
+        return -1;
+    }
+
+    Bitboard columnMask(int col) {
+        static const std::array<Bitboard, BOARD_SIZE> masks = [] {
+            std::array<Bitboard, BOARD_SIZE> built {};
+            for (int col = 0; col < BOARD_SIZE; ++col) built[col] = buildColumnMask(col);
+            return built;
+        }();
+        return masks[col];
+    }
+
+    Bitboard goalMask(Side side) {
+        return side == Side::BLUE ? columnMask(BOARD_SIZE - 1) : columnMask(0);
+    }
+
+    BoardState::BoardState() { reset(); }
+
+    void BoardState::reset() {
+        pawns = { static_cast<uint8_t>(cellIndex(BOARD_SIZE / 2, 0)), static_cast<uint8_t>(cellIndex(BOARD_SIZE / 2, BOARD_SIZE - 1)) };
+        wallsLeft = { WALLS_PER_SIDE, WALLS_PER_SIDE };
+        horizontalWalls = verticalWalls = 0;
+        eastOpen = ALL_CELLS & ~EAST_EDGE;
+        southOpen = ALL_CELLS & ~SOUTH_EDGE;
+        sideToMove = Side::RED; // red opens, same as the scene's first turn
+
+        hash = pawnKey(Side::BLUE, pawns[0]) ^ pawnKey(Side::RED, pawns[1]) ^ wallsLeftKey(Side::BLUE, WALLS_PER_SIDE) ^ wallsLeftKey(Side::RED, WALLS_PER_SIDE) ^ sideToMoveKey();
+    }
+
+    void BoardState::setPawn(Side side, uint8_t cell) {
+        uint8_t& pawn = pawns[static_cast<int>(side)];
+        hash ^= pawnKey(side, pawn) ^ pawnKey(side, cell);
+        pawn = cell;
+    }
+
+    void BoardState::setSideToMove(Side side) {
+        if (side != sideToMove) hash ^= sideToMoveKey();
+        sideToMove = side;
+    }
+
+    bool BoardState::hasWall(MoveType orientation, int slot) const {
+        uint64_t walls = orientation == MoveType::HORIZONTAL_WALL ? horizontalWalls : verticalWalls;
+        return (walls >> slot) & 1ULL;
+    }
+
+    bool BoardState::canStep(int cell, Direction direction) const {
+        switch (direction) {
+            case NORTH: return cellRow(cell) > 0 && (southOpen & cellBit(cell - BOARD_SIZE)) != 0;
+            case EAST: return (eastOpen & cellBit(cell)) != 0;
+            case SOUTH: return (southOpen & cellBit(cell)) != 0;
+            case WEST: return cellCol(cell) > 0 && (eastOpen & cellBit(cell - 1)) != 0;
+        }
+        return false;
+    }
+
+    Bitboard BoardState::getPawnMoves(Side side) const {
+        int from = getPawn(side);
+        int other = getPawn(opponent(side));
+        Bitboard moves = 0;
+
+        for (int dir = NORTH; dir <= WEST; ++dir) {
+            Direction direction = static_cast<Direction>(dir);
+            if (!canStep(from, direction)) continue;
+
+            int next = neighbourCell(from, direction);
+            if (next != other) moves |= cellBit(next);
+            else if (canStep(next, direction)) moves |= cellBit(neighbourCell(next, direction)); // straight jump only, like the scene
+        }
+        return moves;
+    }
+
+    uint64_t BoardState::getPlaceableWalls(MoveType orientation) const {
+        uint64_t blocked;
+        if (orientation == MoveType::HORIZONTAL_WALL) {
+            blocked = horizontalWalls | ((horizontalWalls << 1) & ~WALL_COL0) | ((horizontalWalls >> 1) & ~WALL_COL7) | verticalWalls;
+        } else {
+            blocked = verticalWalls | (verticalWalls << WALL_SIZE) | (verticalWalls >> WALL_SIZE) | horizontalWalls;
+        }
+        return ~blocked;
+    }
+
+    bool BoardState::isWallPlaceable(MoveType orientation, int slot) const {
+        if (orientation == MoveType::PAWN || slot < 0 || slot >= SLOT_COUNT) return false;
+        return (getPlaceableWalls(orientation) >> slot) & 1ULL;
+    }
+
+    void BoardState::placeWall(Side side, MoveType orientation, int slot) {
+        setWall(orientation, slot, true);
+        uint8_t& stock = wallsLeft[static_cast<int>(side)];
+        hash ^= wallsLeftKey(side, stock) ^ wallsLeftKey(side, stock - 1);
+        --stock;
+    }
+
+    void BoardState::removeWall(Side side, MoveType orientation, int slot) {
+        setWall(orientation, slot, false);
+        uint8_t& stock = wallsLeft[static_cast<int>(side)];
+        hash ^= wallsLeftKey(side, stock) ^ wallsLeftKey(side, stock + 1);
+        ++stock;
+    }
+
+    void BoardState::setWall(MoveType orientation, int slot, bool present) {
+        uint64_t& walls = orientation == MoveType::HORIZONTAL_WALL ? horizontalWalls : verticalWalls;
+        if (((walls >> slot) & 1ULL) == static_cast<uint64_t>(present)) return;
+
+        walls ^= 1ULL << slot;
+        hash ^= wallKey(orientation, slot);
+        refreshEdges(orientation, slot);
+    }
+
+    void BoardState::refreshEdges(MoveType orientation, int slot) {
+        int row = slot / WALL_SIZE, col = slot % WALL_SIZE;
+
+        if (orientation == MoveType::HORIZONTAL_WALL) { // south edges of the two cells above the wall
+            for (int c = col; c <= col + 1; ++c) {
+                Bitboard bit = cellBit(cellIndex(row, c));
+                if (testBit(horizontalWalls, row, c) || testBit(horizontalWalls, row, c - 1)) southOpen &= ~bit;
+                else southOpen |= bit;
+            }
+        } else { // east edges of the two cells left of the wall
+            for (int r = row; r <= row + 1; ++r) {
+                Bitboard bit = cellBit(cellIndex(r, col));
+                if (testBit(verticalWalls, r, col) || testBit(verticalWalls, r - 1, col)) eastOpen &= ~bit;
+                else eastOpen |= bit;
+            }
+        }
+    }
+
+    Bitboard BoardState::expand(Bitboard cells) const {
+        return cells
+            | ((cells & eastOpen) << 1)
+            | ((cells & (eastOpen << 1)) >> 1)
+            | ((cells & southOpen) << BOARD_SIZE)
+            | ((cells & (southOpen << BOARD_SIZE)) >> BOARD_SIZE);
+    }
+
+    Bitboard BoardState::reachableFrom(int cell) const {
+        Bitboard reached = cellBit(cell);
+        while (true) {
+            Bitboard next = expand(reached);
+            if (next == reached) return reached;
+            reached = next;
+        }
+    }
+
+    bool BoardState::hasPathToGoal(Side side) const {
+        Bitboard goal = goalMask(side);
+        Bitboard reached = cellBit(getPawn(side));
+        while (!(reached & goal)) {
+            Bitboard next = expand(reached);
+            if (next == reached) return false;
+            reached = next;
+        }
+        return true;
+    }
+
+    int BoardState::shortestPathLength(Side side) const {
+        Bitboard goal = goalMask(side);
+        Bitboard reached = cellBit(getPawn(side));
+        int distance = 0;
+        while (!(reached & goal)) {
+            Bitboard next = expand(reached);
+            if (next == reached) return -1;
+            reached = next;
+            ++distance;
+        }
+        return distance;
+    }
+
+    Bitboard BoardState::getShortestPathCells(Side side) const {
+        std::array<Bitboard, CELL_COUNT> frontier {}; // cells first reached at each step
+        Bitboard goal = goalMask(side);
+        Bitboard reached = cellBit(getPawn(side));
+        frontier[0] = reached;
+
+        int distance = 0;
+        while (!(reached & goal)) {
+            Bitboard next = expand(reached);
+            if (next == reached) return 0;
+            frontier[++distance] = next & ~reached;
+            reached = next;
+        }
+
+        // walk back from the goal cells keeping only frontier cells one open step away
+        Bitboard onPath = frontier[distance] & goal;
+        Bitboard layer = onPath;
+        for (int step = distance - 1; step >= 0; --step) {
+            layer = frontier[step] & expand(layer);
+            onPath |= layer;
+        }
+        return onPath;
+    }
+
+    uint64_t BoardState::getWallsCutting(MoveType orientation, Bitboard cells) const {
+        // cut edges, marked on their north/west cell
+        Bitboard edges = orientation == MoveType::HORIZONTAL_WALL ? (cells & (cells >> BOARD_SIZE) & southOpen) : (cells & (cells >> 1) & eastOpen);
+
+        uint64_t slots = 0;
+        for (int row = 0; row < WALL_SIZE; ++row) {
+            for (int col = 0; col < WALL_SIZE; ++col) {
+                int cell = cellIndex(row, col);
+                int other = orientation == MoveType::HORIZONTAL_WALL ? cell + 1 : cell + BOARD_SIZE; // second edge the slot covers
+                if (edges & (cellBit(cell) | cellBit(other))) slots |= 1ULL << slotIndex(row, col);
+            }
+        }
+        return slots;
+    }
+
+    bool BoardState::isLegalMove(const Move& move) const {
+        if (isGameOver()) return false;
+
+        if (move.type == MoveType::PAWN) {
+            return move.index < CELL_COUNT && (getPawnMoves(sideToMove) & cellBit(move.index)) != 0;
+        }
+
+        if (getWallsLeft(sideToMove) <= 0 || !isWallPlaceable(move.type, move.index)) return false;
+
+        BoardState next = *this;
+        next.setWall(move.type, move.index, true);
+        return next.hasPathToGoal(Side::BLUE) && next.hasPathToGoal(Side::RED);
+    }
+
+    void BoardState::generateMoves(std::vector<Move>& moves) const {
+        moves.clear();
+        if (isGameOver()) return;
+
+        Bitboard pawnMoves = getPawnMoves(sideToMove);
+        while (pawnMoves) {
+            int cell = lowestCell(pawnMoves);
+            pawnMoves &= pawnMoves - 1;
+            moves.push_back(Move{ MoveType::PAWN, static_cast<uint8_t>(cell) });
+        }
+
+        if (getWallsLeft(sideToMove) <= 0) return;
+
+        for (MoveType orientation : { MoveType::HORIZONTAL_WALL, MoveType::VERTICAL_WALL }) {
+            uint64_t slots = getPlaceableWalls(orientation);
+            while (slots) {
+                int slot = __builtin_ctzll(slots);
+                slots &= slots - 1;
+
+                BoardState next = *this;
+                next.setWall(orientation, slot, true);
+                if (next.hasPathToGoal(Side::BLUE) && next.hasPathToGoal(Side::RED)) moves.push_back(Move{ orientation, static_cast<uint8_t>(slot) });
+            }
+        }
+    }
+
+    MoveUndo BoardState::makeMove(const Move& move) {
+        MoveUndo undo{ move, sideToMove, getPawn(sideToMove) };
+        if (move.type == MoveType::PAWN) setPawn(sideToMove, move.index);
+        else placeWall(sideToMove, move.type, move.index);
+        setSideToMove(opponent(sideToMove));
+        return undo;
+    }
+
+    void BoardState::unmakeMove(const MoveUndo& undo) {
+        setSideToMove(undo.side);
+        if (undo.move.type == MoveType::PAWN) setPawn(undo.side, undo.previousCell);
+        else removeWall(undo.side, undo.move.type, undo.move.index);
+    }
+
+    void PathOracle::rebuild(const BoardState& board) {
+        for (Side side : { Side::BLUE, Side::RED }) {
+            Field& field = distance[static_cast<int>(side)];
+            field.fill(UNREACHABLE);
+
+            std::array<Bitboard, CELL_COUNT + 1> levels {};
+            levels[0] = goalMask(side);
+            Bitboard goal = levels[0];
+            while (goal) {
+                field[lowestCell(goal)] = 0;
+                goal &= goal - 1;
+            }
+            relax(board, field, levels);
+        }
+    }
+
+    int PathOracle::getPathLength(const BoardState& board, Side side) const {
+        uint8_t length = distance[static_cast<int>(side)][board.getPawn(side)];
+        return length == UNREACHABLE ? -1 : length;
+    }
+
+    void PathOracle::relax(const BoardState& board, Field& field, std::array<Bitboard, CELL_COUNT + 1>& levels) const {
+        for (int level = 0; level < CELL_COUNT; ++level) {
+            Bitboard cells = levels[level];
+            while (cells) {
+                int cell = lowestCell(cells);
+                cells &= cells - 1;
+                if (field[cell] != level) continue; // lowered again after it was queued
+
+                for (int dir = NORTH; dir <= WEST; ++dir) {
+                    if (!board.canStep(cell, static_cast<Direction>(dir))) continue;
+                    int next = neighbourCell(cell, static_cast<Direction>(dir));
+                    if (field[next] > level + 1) {
+                        field[next] = static_cast<uint8_t>(level + 1);
+                        levels[level + 1] |= cellBit(next);
+                    }
+                }
+            }
+        }
+    }
+
+    Bitboard PathOracle::findInvalidated(const BoardState& board, const Field& field, MoveType orientation, int slot) const {
+        Bitboard invalid = 0;
+        std::array<Bitboard, CELL_COUNT + 1> candidates {};
+        int firstLevel = CELL_COUNT, lastLevel = -1;
+
+        auto addCandidate = [&](int cell) {
+            int level = field[cell];
+            candidates[level] |= cellBit(cell);
+            firstLevel = std::min(firstLevel, level);
+            lastLevel = std::max(lastLevel, level);
+        };
+
+        // only the far end of a cut edge that stepped down through it can lose its route
+        for (const auto& edge : wallEdges(orientation, slot)) {
+            if (field[edge[0]] != UNREACHABLE && field[edge[0]] == field[edge[1]] + 1) addCandidate(edge[0]);
+            else if (field[edge[1]] != UNREACHABLE && field[edge[1]] == field[edge[0]] + 1) addCandidate(edge[1]);
+        }
+
+        // lowest level first so every parent is settled before its children are checked
+        for (int level = firstLevel; level <= lastLevel; ++level) {
+            Bitboard cells = candidates[level];
+            while (cells) {
+                int cell = lowestCell(cells);
+                cells &= cells - 1;
+
+                bool hasParent = level == 0;
+                for (int dir = NORTH; dir <= WEST && !hasParent; ++dir) {
+                    if (!board.canStep(cell, static_cast<Direction>(dir))) continue;
+                    int next = neighbourCell(cell, static_cast<Direction>(dir));
+                    hasParent = field[next] == level - 1 && !(invalid & cellBit(next));
+                }
+                if (hasParent) continue;
+
+                invalid |= cellBit(cell);
+                for (int dir = NORTH; dir <= WEST; ++dir) { // children may have hung off this cell only
+                    if (!board.canStep(cell, static_cast<Direction>(dir))) continue;
+                    int next = neighbourCell(cell, static_cast<Direction>(dir));
+                    if (field[next] == level + 1) addCandidate(next);
+                }
+            }
+        }
+        return invalid;
+    }
+
+    bool PathOracle::keepsExit(const BoardState& board, Side side, MoveType orientation, int slot) const {
+        const Field& field = distance[static_cast<int>(side)];
+        BoardState next = board;
+        next.setWall(orientation, slot, true);
+
+        Bitboard invalid = findInvalidated(next, field, orientation, slot);
+        Bitboard reached = cellBit(board.getPawn(side));
+        if (!(reached & invalid)) return field[board.getPawn(side)] != UNREACHABLE; // route untouched by the wall
+
+        // flood through the invalidated pocket until it touches a cell that still has a route
+        while (true) {
+            Bitboard grown = next.expand(reached);
+            Bitboard outside = grown & ~invalid;
+            while (outside) {
+                if (field[lowestCell(outside)] != UNREACHABLE) return true;
+                outside &= outside - 1;
+            }
+            grown &= invalid;
+            if (grown == reached) return false;
+            reached = grown;
+        }
+    }
+
+    bool PathOracle::keepsBothExits(const BoardState& board, MoveType orientation, int slot) const {
+        return keepsExit(board, Side::BLUE, orientation, slot) && keepsExit(board, Side::RED, orientation, slot);
+    }
+
+    void PathOracle::onWallPlaced(const BoardState& board, MoveType orientation, int slot) {
+        for (Field& field : distance) {
+            Bitboard invalid = findInvalidated(board, field, orientation, slot);
+            if (!invalid) continue;
+
+            Bitboard cells = invalid;
+            while (cells) {
+                field[lowestCell(cells)] = UNREACHABLE;
+                cells &= cells - 1;
+            }
+
+            // reseed the pocket from its still-valid border, then let the buckets settle it
+            std::array<Bitboard, CELL_COUNT + 1> levels {};
+            cells = invalid;
+            while (cells) {
+                int cell = lowestCell(cells);
+                cells &= cells - 1;
+                for (int dir = NORTH; dir <= WEST; ++dir) {
+                    if (!board.canStep(cell, static_cast<Direction>(dir))) continue;
+                    int next = neighbourCell(cell, static_cast<Direction>(dir));
+                    if (!(invalid & cellBit(next)) && field[next] != UNREACHABLE && field[next] + 1 < field[cell]) field[cell] = field[next] + 1;
+                }
+                if (field[cell] != UNREACHABLE) levels[field[cell]] |= cellBit(cell);
+            }
+            relax(board, field, levels);
+        }
+    }
+
+    void PathOracle::onWallRemoved(const BoardState& board, MoveType orientation, int slot) {
+        for (Field& field : distance) {
+            std::array<Bitboard, CELL_COUNT + 1> levels {};
+            for (const auto& edge : wallEdges(orientation, slot)) {
+                for (int end = 0; end < 2; ++end) {
+                    int from = edge[end], to = edge[1 - end];
+                    if (field[from] != UNREACHABLE && field[to] > field[from] + 1) {
+                        field[to] = field[from] + 1;
+                        levels[field[to]] |= cellBit(to);
+                    }
+                }
+            }
+            relax(board, field, levels);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+//
+//  rules.hpp
+//
+//
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+// Compact Quoridor rules engine. Knows nothing about SFML so the scene, an AI, a replay or a server can all share it.
+namespace rules {
+    using Bitboard = unsigned __int128; // one bit per pawn cell, bit index = row * BOARD_SIZE + col
+
+    constexpr int BOARD_SIZE = 9; // 9 x 9 pawn cells
+    constexpr int WALL_SIZE = 8; // 8 x 8 wall slots, slot (row, col) sits between cell rows/cols row..row+1 and col..col+1
+    constexpr int CELL_COUNT = BOARD_SIZE * BOARD_SIZE;
+    constexpr int SLOT_COUNT = WALL_SIZE * WALL_SIZE;
+    constexpr int WALLS_PER_SIDE = 10;
+    constexpr uint8_t NO_CELL = 0xFF;
+
+    // blue starts in the left column and races to the right column, red does the opposite
+    enum class Side : uint8_t { BLUE = 0, RED = 1 };
+    inline Side opponent(Side side) { return side == Side::BLUE ? Side::RED : Side::BLUE; }
+
+    // same numbering as the scene's movement directions (0 up, 1 right, 2 down, 3 left)
+    enum Direction { NORTH = 0, EAST = 1, SOUTH = 2, WEST = 3 };
+
+    enum class MoveType : uint8_t { PAWN, HORIZONTAL_WALL, VERTICAL_WALL };
+
+    struct Move {
+        MoveType type = MoveType::PAWN;
+        uint8_t index = 0; // destination cell for pawn moves, wall slot for walls
+
+        bool isWall() const { return type != MoveType::PAWN; }
+        bool operator==(const Move& other) const { return type == other.type && index == other.index; }
+        bool operator!=(const Move& other) const { return !(*this == other); }
+    };
+
+    struct MoveUndo {
+        Move move;
+        Side side = Side::BLUE;
+        uint8_t previousCell = NO_CELL; // pawn cell before a pawn move
+    };
+
+    constexpr int cellIndex(int row, int col) { return row * BOARD_SIZE + col; }
+    constexpr int slotIndex(int row, int col) { return row * WALL_SIZE + col; }
+    constexpr int cellRow(int cell) { return cell / BOARD_SIZE; }
+    constexpr int cellCol(int cell) { return cell % BOARD_SIZE; }
+    inline Bitboard cellBit(int cell) { return Bitboard(1) << cell; }
+    int lowestCell(Bitboard cells); // index of the lowest set bit, cells must be non-empty
+    int neighbourCell(int cell, Direction direction); // -1 when stepping off the board
+    Bitboard columnMask(int col);
+    Bitboard goalMask(Side side);
+
+    // Zobrist keys, fixed seed so hashes match across runs and threads
+    uint64_t pawnKey(Side side, int cell);
+    uint64_t wallKey(MoveType orientation, int slot);
+    uint64_t wallsLeftKey(Side side, int count);
+    uint64_t sideToMoveKey(); // xored in while red is to move
+
+    class BoardState {
+    public:
+        BoardState();
+        void reset(); // empty board, pawns in the middle of their start columns, full wall stock, red to move
+
+        uint8_t getPawn(Side side) const { return pawns[static_cast<int>(side)]; }
+        void setPawn(Side side, uint8_t cell);
+        int getWallsLeft(Side side) const { return wallsLeft[static_cast<int>(side)]; }
+        Side getSideToMove() const { return sideToMove; }
+        void setSideToMove(Side side);
+        uint64_t getHash() const { return hash; } // Zobrist hash of pawns, walls, stocks and side to move, kept incrementally
+
+        uint64_t getHorizontalWalls() const { return horizontalWalls; }
+        uint64_t getVerticalWalls() const { return verticalWalls; }
+        bool hasWall(MoveType orientation, int slot) const;
+
+        // movement
+        bool canStep(int cell, Direction direction) const; // true if no wall or board edge between cell and its neighbour
+        Bitboard getPawnMoves(Side side) const; // single steps plus straight jumps over the other pawn
+        bool hasReachedGoal(Side side) const { return (cellBit(getPawn(side)) & goalMask(side)) != 0; }
+        bool isGameOver() const { return hasReachedGoal(Side::BLUE) || hasReachedGoal(Side::RED); }
+
+        // walls
+        uint64_t getPlaceableWalls(MoveType orientation) const; // free slots that neither overlap nor cross a placed wall
+        bool isWallPlaceable(MoveType orientation, int slot) const;
+        void placeWall(Side side, MoveType orientation, int slot); // no legality checks; callers validate first
+        void removeWall(Side side, MoveType orientation, int slot);
+        void setWall(MoveType orientation, int slot, bool present); // wall sets only, stocks untouched (what-if queries)
+
+        // paths (walls only, pawns never block a path)
+        Bitboard expand(Bitboard cells) const; // cells plus every cell one open step away
+        Bitboard reachableFrom(int cell) const;
+        bool hasPathToGoal(Side side) const;
+        int shortestPathLength(Side side) const; // -1 if sealed in
+        Bitboard getShortestPathCells(Side side) const; // every cell on at least one shortest route, empty if sealed in
+        uint64_t getWallsCutting(MoveType orientation, Bitboard cells) const; // slots whose wall would cut an open edge between two of cells
+
+        // full moves for the side to move
+        bool isLegalMove(const Move& move) const;
+        void generateMoves(std::vector<Move>& moves) const;
+        MoveUndo makeMove(const Move& move);
+        void unmakeMove(const MoveUndo& undo);
+
+    private:
+        void refreshEdges(MoveType orientation, int slot); // rebuilds the open-edge bits a slot touches from the wall sets
+
+        std::array<uint8_t, 2> pawns {};
+        std::array<uint8_t, 2> wallsLeft {};
+        uint64_t horizontalWalls = 0; // bit = slotIndex(row, col)
+        uint64_t verticalWalls = 0;
+        Bitboard eastOpen = 0; // cells that can step east
+        Bitboard southOpen = 0; // cells that can step south
+        Side sideToMove = Side::RED;
+        uint64_t hash = 0;
+    };
+
+    // Distance-to-goal field for both sides, kept up to date wall by wall. Pawns never block paths so pawn moves don't touch it.
+    // A placed wall only raises the cells whose shortest route crossed it, a removed wall only lowers cells near it,
+    // so both updates stay local instead of re-flooding the board.
+    class PathOracle {
+    public:
+        static constexpr uint8_t UNREACHABLE = 0xFF;
+
+        PathOracle() = default;
+        explicit PathOracle(const BoardState& board) { rebuild(board); }
+        void rebuild(const BoardState& board); // full BFS out of each goal column
+
+        int getDistance(Side side, int cell) const { return distance[static_cast<int>(side)][cell]; }
+        int getPathLength(const BoardState& board, Side side) const; // -1 if sealed in
+
+        // board is the position before the wall goes down
+        bool keepsExit(const BoardState& board, Side side, MoveType orientation, int slot) const;
+        bool keepsBothExits(const BoardState& board, MoveType orientation, int slot) const;
+
+        // board is the position after the change
+        void onWallPlaced(const BoardState& board, MoveType orientation, int slot);
+        void onWallRemoved(const BoardState& board, MoveType orientation, int slot);
+
+    private:
+        using Field = std::array<uint8_t, CELL_COUNT>;
+
+        Bitboard findInvalidated(const BoardState& board, const Field& field, MoveType orientation, int slot) const; // cells that lost every shortest route
+        void relax(const BoardState& board, Field& field, std::array<Bitboard, CELL_COUNT + 1>& levels) const; // settles level buckets in increasing order
+
+        std::array<Field, 2> distance {};
+    };
+}
@@ -83,6 +83,7 @@ void lobbyScene::handleGameEvents() {
         FlagSystem::lobbyEvents.sceneStart = false;
 
         FlagSystem::gameScene1Flags.sceneStart = true;
+        FlagSystem::gameScene1Flags.computerOpponent = Constants::AI_ENABLED; // "1 comp" plays against the computer
 
         FlagSystem::flagEvents.mouseClicked = false;
     }
@@ -197,6 +198,10 @@ gamePlayScene::gamePlayScene(sf::RenderWindow& gameWindow) : Scene(gameWindow) {
     log_info("gameplay scene made"); 
 }
 
+gamePlayScene::~gamePlayScene() {
+    stopComputerOpponent();
+}
+
 // Gets called once before the main game loop 
 void gamePlayScene::createAssets() {
     try {
@@ -220,12 +225,6 @@ void gamePlayScene::createAssets() {
         backgroundBigFinal = std::make_unique<Sprite>(Constants::BACKGROUNDBIGFINAL_POSITION, Constants::BACKGROUNDBIGFINAL_SCALE, Constants::BACKGROUNDBIGFINAL_TEXTURE); 
         backgroundBigFinal->setVisibleState(false); // hide final background at the start
 
-        backgroundBigHalfRed = std::make_unique<Sprite>(Constants::BACKGROUNDBIGHALF_POSITION, Constants::BACKGROUNDBIGHALF_SCALE, Constants::BACKGROUNDBIGHALF_TEXTURE);
-        backgroundBigHalfRed->setVisibleState(false); // hide half background at the start
-
-        backgroundBigHalfBlue = std::make_unique<Sprite>(Constants::BACKGROUNDBIGHALF_POSITION, Constants::BACKGROUNDBIGHALF_SCALE, Constants::BACKGROUNDBIGHALF_TEXTURE);
-        backgroundBigHalfBlue->setVisibleState(false); // hide half background at the start
-
         button1 = std::make_unique<Button>(Constants::BUTTON1_POSITION, Constants::BUTTON1_SCALE, Constants::BUTTON1_TEXTURE, Constants::BUTTON1_ANIMATIONRECTS, Constants::BUTTON1_INDEXMAX, utils::convertToWeakPtrVector(Constants::BUTTON1_BITMASK)); 
         button1->setRects(0); 
 
@@ -244,6 +243,8 @@ void gamePlayScene::createAssets() {
 
         boardTileMap = std::make_unique<BoardTileMap>(boardTiles, Constants::BOARDTILES_ROW, Constants::BOARDTILES_COL); // 19 x 21 tiles including walls
 
+        stopComputerOpponent(); // the lobby picks the mode after this, the first runScene starts the engine
+
         rays = sf::VertexArray(sf::Quads, Constants::RAYS_NUM);
         rays2 = sf::VertexArray(sf::Quads, Constants::RAYS_NUM);
 
@@ -262,6 +263,24 @@ void gamePlayScene::createAssets() {
 
         player1Text = std::make_unique<TextClass>(Constants::PLAYER1TEXT_POSITION, Constants::PLAYER1TEXT_SIZE, Constants::PLAYER1TEXT_COLOR, Constants::TEXT_FONT, Constants::PLAYER1TEXT_MESSAGE);
         player2Text = std::make_unique<TextClass>(Constants::PLAYER2TEXT_POSITION, Constants::PLAYER2TEXT_SIZE, Constants::PLAYER2TEXT_COLOR, Constants::TEXT_FONT, Constants::PLAYER2TEXT_MESSAGE); 
+
+        // middle view statics, same pixel density as the view so compositing is 1:1
+        float pixelsPerUnit = window.getSize().x * MetaComponents::middleView.getViewport().width / Constants::VIEW_SIZE_X;
+        sf::FloatRect boardArea = boardTileMap->getTile(0)->getTileSprite().getGlobalBounds(); // board plus every stick's starting spot, placed sticks land on the board
+        auto coverBounds = [&boardArea](const sf::FloatRect& bounds) {
+            float right = std::max(boardArea.left + boardArea.width, bounds.left + bounds.width);
+            float bottom = std::max(boardArea.top + boardArea.height, bounds.top + bounds.height);
+            boardArea.left = std::min(boardArea.left, bounds.left);
+            boardArea.top = std::min(boardArea.top, bounds.top);
+            boardArea.width = right - boardArea.left;
+            boardArea.height = bottom - boardArea.top;
+        };
+        for (size_t i = 0; i < boardTileMap->getTileMapNumber(); ++i) coverBounds(boardTileMap->getTile(i)->getTileSprite().getGlobalBounds());
+        for (const auto& stick : sticksBlue) coverBounds(stick->returnSpritesShape().getGlobalBounds());
+        for (const auto& stick : sticksRed) coverBounds(stick->returnSpritesShape().getGlobalBounds());
+        boardLayer.create(boardArea, pixelsPerUnit);
+        hudLayer.create(Constants::VIEW_RECT, pixelsPerUnit);
+
         insertItemsInQuadtree(); 
         setInitialTimes();
 
@@ -277,6 +296,7 @@ void gamePlayScene::setInitialTimes(){
 }
 
 void gamePlayScene::insertItemsInQuadtree(){
+    quadtree.clear(); // the players are new every time the assets are made
     quadtree.insert(player);  
     quadtree.insert(player2);
 }
@@ -298,17 +318,24 @@ void gamePlayScene::setTime(){
 } 
 
 void gamePlayScene::handleInput() {
-    handleMouseKey();
+    if (FlagSystem::gameScene1Flags.computerOpponent && !computerPlayer) startComputerOpponent();
+    if (isComputerTurn()) handleComputerTurn();
+    else handleMouseKey();
     handleSpaceKey(); 
     handleMovementKeys();
 }
 
-// // need to have enterance to other side at least one way & player be able to move in at least one direction
-// bool gamePlayScene::playerHasExit(const std::unique_ptr<Player>& currentPlayer, bool isPlayer1) const {
-//     if (!boardTileMap || !currentPlayer) return false; 
+// need to have enterance to other side at least one way after the wall goes down
+bool gamePlayScene::playerHasExit(const rules::Move& wallMove, bool isPlayer1) const {
+    if (!boardTileMap) return false; 
 
-//     return true; 
-// }
+    rules::Side side = isPlayer1 ? rules::Side::BLUE : rules::Side::RED;
+    return boardTileMap->getPathOracle().keepsExit(boardTileMap->getBoardState(), side, wallMove.type, wallMove.index); 
+}
+
+rules::Side gamePlayScene::getMovingSide() const {
+    return FlagSystem::gameScene1Flags.playerBlueTurn ? rules::Side::RED : rules::Side::BLUE; // blue turn flag moves the red player
+}
 
 void gamePlayScene::handleMouseKey() { 
 
@@ -321,19 +348,13 @@ void gamePlayScene::handleMouseKey() {
     sf::Vector2f mousePos = MetaComponents::middleViewmouseCurrentPosition_f;
     if (mousePos.x == 0.0f && mousePos.y == 0.0f)  mousePos = sf::Vector2f{20.0f, 20.0f}; // Default position
 
-    int currentTileIndex = -1;
-    try {
-        currentTileIndex = boardTileMap->getTileIndex(mousePos);
-    } catch (const std::out_of_range& e) {
-        return;  // Mouse is outside tilemap bounds - exit early
-    }
-
-    if (currentTileIndex < 0 || currentTileIndex >= boardTileMap->getTileMapNumber()) return;
+    std::optional<size_t> currentTileIndex = boardTileMap->getTileIndex(mousePos);
+    if (!currentTileIndex) return;  // Mouse is outside tilemap bounds - exit early
 
-    size_t targetTileIndex = currentTileIndex;
+    size_t targetTileIndex = *currentTileIndex;
 
     // Find closest grey tile if current isn't grey
-    if (!boardTileMap->isGreyTile(currentTileIndex)) {
+    if (!boardTileMap->isGreyTile(*currentTileIndex)) {
         float minDistance = std::numeric_limits<float>::max();
         bool foundGreyTile = false;
 
@@ -354,57 +375,36 @@ void gamePlayScene::handleMouseKey() {
         if (!foundGreyTile) return;
     }
 
-    int row = targetTileIndex / Constants::BOARDTILES_ROW;
-    int col = targetTileIndex % Constants::BOARDTILES_ROW;
+    std::optional<rules::Move> wallMove = boardTileMap->getWallMove(targetTileIndex);
     bool isVertical = boardTileMap->isVerticalWallTile(targetTileIndex);
 
     sf::Vector2f stickPos = boardTileMap->getTile(targetTileIndex)->getTileSprite().getPosition();
     if (isVertical) stickPos.x += 9.0f;
 
+    // preview fades out where the wall can't go (overlap, crossing, or sealing a pawn in)
+    bool legalWall = wallMove && boardTileMap->getBoardState().isWallPlaceable(wallMove->type, wallMove->index) && playerHasExit(*wallMove, true) && playerHasExit(*wallMove, false);
+    sf::Color previewColor = legalWall ? sf::Color::White : sf::Color(255, 255, 255, 90);
+
     if(FlagSystem::gameScene1Flags.playerBlueTurn){
         sticksBlue[stickIndex]->returnSpritesShape().setPosition(stickPos);
         sticksBlue[stickIndex]->returnSpritesShape().setRotation(isVertical ? 90.0f : 0.0f);
+        sticksBlue[stickIndex]->returnSpritesShape().setColor(previewColor);
     } else if (FlagSystem::gameScene1Flags.playerRedTurn){
         sticksRed[stickIndex]->returnSpritesShape().setPosition(stickPos);
         sticksRed[stickIndex]->returnSpritesShape().setRotation(isVertical ? 90.0f : 0.0f);
+        sticksRed[stickIndex]->returnSpritesShape().setColor(previewColor);
     }
 
-    if (!FlagSystem::flagEvents.mouseClicked) return; // Only apply changes on click
-
-    unsigned int nextBlankTileIndex, nextTileIndex;
-    bool validPlacement = false;
+    if (!FlagSystem::flagEvents.mouseClicked || !legalWall) return; // Only apply changes on click
 
-    if (isVertical) {
-        if (row < Constants::BOARDTILES_ROW) {
-            nextBlankTileIndex = targetTileIndex + Constants::BOARDTILES_ROW + 2;
-            nextTileIndex = nextBlankTileIndex + Constants::BOARDTILES_ROW + 2;
-            validPlacement = true;
-        }
-    } else {
-        if (col < Constants::BOARDTILES_ROW) {
-            nextBlankTileIndex = targetTileIndex + 1;
-            nextTileIndex = nextBlankTileIndex + 1;
-            validPlacement = true;
-        }
-    }
+    // engine rejects overlapping and crossing walls, then blocks the three tiles
+    rules::Side side = getMovingSide();
+    if (!boardTileMap->placeWall(side, *wallMove)) return;
+    boardLayer.invalidate(); // the previewed stick stays where it is and joins the cached ones
 
-    // bool player1HasExit = playerHasExit(player, true);
-    // bool player2HasExit = playerHasExit(player2, false);
-
-    bool player1HasExit = true;
-    bool player2HasExit = true;
-
-    if (!validPlacement || nextBlankTileIndex >= boardTileMap->getTileMapNumber() || nextTileIndex >= boardTileMap->getTileMapNumber() || !player1HasExit || !player2HasExit) return;
-
-    // Before placing, verify all involved tiles are walkable
-    if (!boardTileMap->getTile(targetTileIndex)->getWalkable() || !boardTileMap->getTile(nextBlankTileIndex)->getWalkable() || !boardTileMap->getTile(nextTileIndex)->getWalkable()) return;
-
-    boardTileMap->getTile(targetTileIndex)->setWalkable(false);
-    boardTileMap->getTile(nextBlankTileIndex)->setWalkable(false);
-    boardTileMap->getTile(nextTileIndex)->setWalkable(false);
-
-    if(FlagSystem::gameScene1Flags.playerBlueTurn) ++stickIndexBlue;
-    else if (FlagSystem::gameScene1Flags.playerRedTurn) ++stickIndexRed;
+    unsigned int sticksUsed = rules::WALLS_PER_SIDE - boardTileMap->getBoardState().getWallsLeft(side);
+    if(FlagSystem::gameScene1Flags.playerBlueTurn) stickIndexBlue = sticksUsed;
+    else if (FlagSystem::gameScene1Flags.playerRedTurn) stickIndexRed = sticksUsed;
     FlagSystem::gameScene1Flags.stickPlaced = true;
     if (FlagSystem::flagEvents.mouseClicked && buttonClickSound) buttonClickSound->returnSound().play();
 
@@ -420,8 +420,150 @@ void gamePlayScene::handleSpaceKey() {
 }
 
 void gamePlayScene::handleMovementKeys() {
-    handleEachPlayer(player, player2, p1pathCount, p1PrevPathIndex);
-    handleEachPlayer(player2, player, p2pathCount, p2PrevPathIndex);
+    // keyboard never drives the computer's pawn
+    if (!computerPlayer || computerSide != rules::Side::BLUE) handleEachPlayer(player, player2, p1pathCount, p1PrevPathIndex);
+    if (!computerPlayer || computerSide != rules::Side::RED) handleEachPlayer(player2, player, p2pathCount, p2PrevPathIndex);
+}
+
+void gamePlayScene::startComputerOpponent() {
+    if (Constants::AI_ENGINE == "mcts") {
+        ai::MctsSettings settings;
+        settings.policy = Constants::AI_MCTS_POLICY == "uct" ? ai::SelectionPolicy::UCT : ai::SelectionPolicy::PUCT;
+        settings.exploration = Constants::AI_MCTS_EXPLORATION;
+        settings.nodeLimit = Constants::AI_MCTS_NODE_LIMIT;
+        settings.threadCount = Constants::AI_THREADS;
+        computerPlayer = std::make_unique<ai::MonteCarloSearch>(settings);
+    } else {
+        computerPlayer = std::make_unique<ai::AlphaBetaSearch>(Constants::AI_TT_SIZE_MB, Constants::AI_THREADS);
+    }
+    computerSide = Constants::AI_PLAYS_RED ? rules::Side::RED : rules::Side::BLUE;
+    log_info("computer opponent " + computerPlayer->getName() + " plays " + (computerSide == rules::Side::RED ? "red" : "blue"));
+}
+
+void gamePlayScene::stopComputerOpponent() {
+    if (computerSearch.valid()) computerSearch.wait(); // the search thread still uses the engine
+    computerSearch = std::future<ai::SearchResult>();
+    computerPlayer.reset();
+}
+
+bool gamePlayScene::isComputerTurn() const {
+    return computerPlayer && getMovingSide() == computerSide;
+}
+
+void gamePlayScene::handleComputerTurn() {
+    if (FlagSystem::flagEvents.gameEnd || FlagSystem::gameScene1Flags.moved || FlagSystem::gameScene1Flags.stickPlaced) return; 
+
+    if (!computerSearch.valid()) {
+        std::unique_ptr<Player>& computerPawn = computerSide == rules::Side::BLUE ? player : player2;
+        std::optional<size_t> pawnTileIndex = boardTileMap->getTileIndex(computerPawn->getSpritePos());
+        if (!pawnTileIndex) return;
+
+        // step off the start strip onto the board first, free like it is for a human
+        bool onStartStrip = computerSide == rules::Side::BLUE ? boardTileMap->isP1StartTile(*pawnTileIndex) : boardTileMap->isP2StartTile(*pawnTileIndex);
+        if (onStartStrip) moveComputerPawn(boardTileMap->getCellTileIndex(boardTileMap->getBoardState().getPawn(computerSide)));
+
+        rules::BoardState position = boardTileMap->getBoardState();
+        position.setSideToMove(computerSide);
+
+        // engine goal column reached, the last step onto the goal strip wins
+        if (position.hasReachedGoal(computerSide)) {
+            size_t row = boardTileMap->getCellTileIndex(position.getPawn(computerSide)) / Constants::BOARDTILES_COL;
+            moveComputerPawn(row * Constants::BOARDTILES_COL + (computerSide == rules::Side::BLUE ? Constants::BOARDTILES_COL - 2 : 1));
+            FlagSystem::gameScene1Flags.moved = true;
+            return;
+        }
+
+        // other pawn is one step from winning, nothing left to search so just run for it
+        if (position.isGameOver()) {
+            std::optional<rules::Move> step = getBestComputerStep(position);
+            if (step) applyComputerMove(*step);
+            return;
+        }
+
+        ai::SearchLimits limits;
+        limits.timeBudget = std::chrono::milliseconds(Constants::AI_TIME_BUDGET_MS);
+        limits.maxDepth = Constants::AI_MAX_DEPTH;
+
+        ai::MoveSource* source = computerPlayer.get();
+        computerSearch = std::async(std::launch::async, [source, position, limits]() { return source->search(position, limits); });
+        return;
+    }
+
+    if (computerSearch.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return; // keep rendering while it thinks
+
+    ai::SearchResult result = computerSearch.get();
+    std::string stats = result.playouts ? std::to_string(result.getPlayoutsPerSecond()) + " playouts/s" : "tt hit rate " + std::to_string(result.getTTHitRate());
+    log_info(computerPlayer->getName() + " searched depth " + std::to_string(result.depth) + ", " + std::to_string(result.nodes) + " nodes in " + std::to_string(result.elapsedMs) + " ms, " + stats);
+    if (result.hasMove) applyComputerMove(result.bestMove);
+}
+
+// pawn step with the shortest way home left, no search
+std::optional<rules::Move> gamePlayScene::getBestComputerStep(const rules::BoardState& position) const {
+    rules::Bitboard steps = position.getPawnMoves(computerSide);
+    std::optional<rules::Move> bestStep;
+    int bestLength = std::numeric_limits<int>::max();
+    while (steps) {
+        rules::Move step { rules::MoveType::PAWN, static_cast<uint8_t>(rules::lowestCell(steps)) };
+        steps &= steps - 1;
+        rules::BoardState next = position;
+        next.setPawn(computerSide, step.index);
+        int length = next.shortestPathLength(computerSide);
+        if (length >= 0 && length < bestLength) { bestLength = length; bestStep = step; }
+    }
+    return bestStep;
+}
+
+void gamePlayScene::applyComputerMove(const rules::Move& move) {
+    if (move.type == rules::MoveType::PAWN) {
+        moveComputerPawn(boardTileMap->getCellTileIndex(move.index));
+        boardTileMap->syncPawn(computerSide, boardTileMap->getCellTileIndex(move.index));
+        FlagSystem::gameScene1Flags.moved = true;
+        return;
+    }
+
+    if (!boardTileMap->placeWall(computerSide, move)) {
+        // searching the same position again would pick the same wall, step instead so the turn still ends
+        log_warning("Computer picked a wall the board rejected, stepping instead");
+        rules::BoardState position = boardTileMap->getBoardState();
+        position.setSideToMove(computerSide);
+        std::optional<rules::Move> step = getBestComputerStep(position);
+        if (step) applyComputerMove(*step);
+        else FlagSystem::gameScene1Flags.moved = true; // boxed in, pass rather than stall
+        return;
+    }
+
+    // same stick sprite placement as a mouse click
+    size_t wallTileIndex = boardTileMap->getWallTileIndices(move)[0];
+    bool isVertical = move.type == rules::MoveType::VERTICAL_WALL;
+    sf::Vector2f stickPos = boardTileMap->getTile(wallTileIndex)->getTileSprite().getPosition();
+    if (isVertical) stickPos.x += 9.0f;
+
+    unsigned int sticksUsed = rules::WALLS_PER_SIDE - boardTileMap->getBoardState().getWallsLeft(computerSide);
+    unsigned int& stickIndex = computerSide == rules::Side::RED ? stickIndexBlue : stickIndexRed; // red places the "blue" sticks, see getMovingSide
+    auto& sticks = computerSide == rules::Side::RED ? sticksBlue : sticksRed;
+    if (stickIndex < sticks.size()) {
+        sticks[stickIndex]->returnSpritesShape().setPosition(stickPos);
+        sticks[stickIndex]->returnSpritesShape().setRotation(isVertical ? 90.0f : 0.0f);
+        sticks[stickIndex]->returnSpritesShape().setColor(sf::Color::White);
+    }
+    stickIndex = sticksUsed;
+    boardLayer.invalidate();
+    FlagSystem::gameScene1Flags.stickPlaced = true;
+}
+
+void gamePlayScene::moveComputerPawn(size_t tileIndex) {
+    std::unique_ptr<Player>& computerPawn = computerSide == rules::Side::BLUE ? player : player2;
+    sf::FloatRect tileBounds = boardTileMap->getTile(tileIndex)->getTileSprite().getGlobalBounds();
+    sf::Vector2f target { tileBounds.left + tileBounds.width / 2.0f, tileBounds.top + tileBounds.height / 2.0f };
+
+    // face the way it moved so the 3D view looks down the board
+    sf::Vector2f delta = target - computerPawn->getSpritePos();
+    if (delta.x != 0.0f || delta.y != 0.0f) {
+        computerPawn->returnSpritesShape().setRotation(std::atan2(delta.y, delta.x) * 180.0f / 3.14159f);
+        computerPawn->setHeadingAngle(computerPawn->returnSpritesShape().getRotation());
+    }
+    computerPawn->changePosition(target);
+    computerPawn->updatePos();
 }
 
 void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::unique_ptr<Player>& playerToCheck, size_t& moveCount, unsigned int& prevPathIndex) { 
@@ -439,7 +581,7 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
 
     // Reset turn state at beginning of new move cycle 
     if (moveCount == 0) { 
-        prevPathIndex = boardTileMap->getTileIndex(playerNum->getSpritePos()); 
+        prevPathIndex = boardTileMap->getTileIndex(playerNum->getSpritePos()).value_or(prevPathIndex); 
         playerNum->setTurnInProgress(false); 
         playerNum->setTilesMovedThisTurn(0); 
         playerNum->setIsMoving(false); 
@@ -449,7 +591,9 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
     ++moveCount; 
 
     sf::Vector2f currentPos = playerNum->getSpritePos(); 
-    unsigned int currentTileIndex = boardTileMap->getTileIndex(currentPos); 
+    std::optional<size_t> currentTile = boardTileMap->getTileIndex(currentPos); 
+    if (!currentTile) return; 
+    unsigned int currentTileIndex = *currentTile; 
 
     // Check if player is on their start tile
     bool isOnStartTile = boardTileMap->isP1StartTile(currentTileIndex) || boardTileMap->isP2StartTile(currentTileIndex);
@@ -460,30 +604,12 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
         sf::FloatRect testBounds(pos.x - playerBounds.width * 0.3f, pos.y - playerBounds.height * 0.2f, 
                                 playerBounds.width * 0.6f, playerBounds.height * 0.4f); 
 
-        int collisionCount = 0; 
-        for (int i = 0; i < Constants::BOARDTILES_ROW * Constants::BOARDTILES_COL; ++i) { 
-            try { 
-                auto& tile = boardTileMap->getTile(i); 
-                if (tile && tile->getVisibleState() && !tile->getWalkable() && 
-                    tile->getTileSprite().getGlobalBounds().intersects(testBounds)) collisionCount++;
-            } catch (const std::exception& e) { 
-                log_warning("Tile collision check error: " + std::string(e.what())); 
-            } 
-        } 
+        int collisionCount = boardTileMap->countBlockedTiles(testBounds); 
 
         if (isBackward) { 
             sf::FloatRect currentBounds(currentPos.x - playerBounds.width * 0.3f, currentPos.y - playerBounds.height * 0.2f, 
                                        playerBounds.width * 0.6f, playerBounds.height * 0.4f); 
-            int currentCollisions = 0; 
-            for (int i = 0; i < Constants::BOARDTILES_ROW * Constants::BOARDTILES_COL; ++i) { 
-                try { 
-                    auto& tile = boardTileMap->getTile(i); 
-                    if (tile && tile->getVisibleState() && !tile->getWalkable() && 
-                        tile->getTileSprite().getGlobalBounds().intersects(currentBounds)) currentCollisions++;
-                } catch (const std::exception& e) { 
-                    log_warning("Current collision check error: " + std::string(e.what())); 
-                } 
-            } 
+            int currentCollisions = boardTileMap->countBlockedTiles(currentBounds); 
             return collisionCount <= currentCollisions; 
         } 
         return collisionCount == 0; 
@@ -546,9 +672,9 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
     // Check if other player is 2 tiles away
     auto isOtherPlayerAt2Tiles = [&](int direction) -> bool {
         if (!playerToCheck) return false;
-        unsigned int otherPlayerTileIndex = boardTileMap->getTileIndex(playerToCheck->getSpritePos());
+        std::optional<size_t> otherPlayerTileIndex = boardTileMap->getTileIndex(playerToCheck->getSpritePos());
         int expectedTileIndex = getAdjacentTileIndex(currentTileIndex, direction, 2);
-        return (expectedTileIndex != -1 && expectedTileIndex == otherPlayerTileIndex);
+        return (expectedTileIndex != -1 && otherPlayerTileIndex && expectedTileIndex == *otherPlayerTileIndex);
     };
 
     // Handle ongoing movement
@@ -656,7 +782,8 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
     playerNum->updatePos(); 
 
     // Complete turn logic - MODIFIED: Only end turn if not on start tile
-    unsigned int newTileIndex = boardTileMap->getTileIndex(playerNum->getSpritePos()); 
+    unsigned int newTileIndex = boardTileMap->getTileIndex(playerNum->getSpritePos()).value_or(currentTileIndex); 
+    boardTileMap->syncPawn(playerNum == player ? rules::Side::BLUE : rules::Side::RED, newTileIndex);
     bool shouldEndTurn = (!isSpecialMovement) || (isSpecialMovement && hasReachedOtherPlayer && tilesMovedThisTurn >= 4);
     // std::cout  << "new tile index: " << newTileIndex << std::endl;
     // std::cout << "previous tile index: " << prevPathIndex << std::endl;     
@@ -677,24 +804,39 @@ void gamePlayScene::handleEachPlayer(std::unique_ptr<Player>& playerNum, std::un
 }
 
 void gamePlayScene::handleGameEvents() { 
-    player1Text->updateText(Constants::PLAYER1TEXT_MESSAGE + " " + std::to_string(Constants::STICKS_NUMBER / 2 - stickIndexRed) + "/" + std::to_string(Constants::STICKS_NUMBER / 2));
-    player2Text->updateText(Constants::PLAYER2TEXT_MESSAGE + " " + std::to_string(Constants::STICKS_NUMBER / 2 - stickIndexBlue) + "/" + std::to_string(Constants::STICKS_NUMBER / 2));
+    updateHudText(player1Text, Constants::PLAYER1TEXT_MESSAGE + " " + std::to_string(Constants::STICKS_NUMBER / 2 - stickIndexRed) + "/" + std::to_string(Constants::STICKS_NUMBER / 2));
+    updateHudText(player2Text, Constants::PLAYER2TEXT_MESSAGE + " " + std::to_string(Constants::STICKS_NUMBER / 2 - stickIndexBlue) + "/" + std::to_string(Constants::STICKS_NUMBER / 2));
 
-    physics::calculateRayCast3d(player, boardTileMap, rays, wallLine); // board specific
-    physics::calculateRayCast3d(player2, boardTileMap, rays2, wallLine2); // board specific
+    // both views only read the board, so their ray chunks and the two pawn projections go out as one batch,
+    // each job writes its own rays or its own pawn and the batch is joined before anything is drawn
+    std::array<physics::RayCastFrame, 2> frames;
+    physics::prepareRayCast(player, boardTileMap, rays, wallLine, rayFan, frames[0], &rayCache); // board specific
+    physics::prepareRayCast(player2, boardTileMap, rays2, wallLine2, rayFan2, frames[1], &rayCache2); // board specific
 
     pawn2->updateSpritePos(player2->getSpritePos()); 
     pawn->updateSpritePos(player->getSpritePos());
 
-    physics::calculateSprite3D(pawn2, player, boardTileMap, pawnRedBlocked);
-    physics::calculateSprite3D(pawn, player2, boardTileMap, pawnBlueBlocked); 
-
-    backgroundBigHalfRed->setVisibleState(pawnRedBlocked);
-    backgroundBigHalfBlue->setVisibleState(pawnBlueBlocked);
+    const size_t chunks1 = frames[0].getChunkCount();
+    const size_t chunks2 = frames[1].getChunkCount();
+    viewJobs.parallelFor(2 + chunks1 + chunks2, [&](size_t job) {
+        if (job == 0) return physics::calculateSprite3D(pawn2, player, boardTileMap);
+        if (job == 1) return physics::calculateSprite3D(pawn, player2, boardTileMap);
+        job -= 2;
+        if (job < chunks1) physics::castRayChunk(frames[0], job);
+        else physics::castRayChunk(frames[1], job - chunks1);
+    });
+
+    // pawns go in after the batch, clipping reads the depth the ray jobs just wrote
+    pawnSlices.clear();
+    pawnSlices.setPrimitiveType(sf::Quads);
+    physics::clipSprite3D(pawn2, player, rayFan, pawnSlices);
+    pawnSlices2.clear();
+    pawnSlices2.setPrimitiveType(sf::Quads);
+    physics::clipSprite3D(pawn, player2, rayFan2, pawnSlices2);
 
     // check which players turn
     if(FlagSystem::gameScene1Flags.playerRedTurn) {
-        introText->updateText("waiting for BLUE turn . . .");
+        updateHudText(introText, "waiting for BLUE turn . . .");
         player->setMoveState(true); // player 1 can move
         player2->setMoveState(false); // player 2 cannot move
 
@@ -703,19 +845,21 @@ void gamePlayScene::handleGameEvents() {
             FlagSystem::gameScene1Flags.playerBlueTurn = true; // set player 2's turn
             FlagSystem::gameScene1Flags.moved = false; // reset moved flag
             FlagSystem::gameScene1Flags.stickPlaced = false; // reset stick placed flag
+            boardTileMap->getBoardState().setSideToMove(rules::Side::RED);
         }
 
-        if(boardTileMap->isP2StartTile(boardTileMap->getTileIndex(player->getSpritePos()))) {
+        std::optional<size_t> playerTileIndex = boardTileMap->getTileIndex(player->getSpritePos());
+        if(playerTileIndex && boardTileMap->isP2StartTile(*playerTileIndex)) {
             FlagSystem::flagEvents.gameEnd = true; // player 1 reached goal tile
             backgroundBigFinal->setVisibleState(true); // show final background
             backgroundBig->setVisibleState(false); // hide initial background
-            introText->updateText("Player blue wins!"); 
+            updateHudText(introText, "Player blue wins!"); 
 
             endingText->setVisibleState(true); 
         }
     }
     else if(FlagSystem::gameScene1Flags.playerBlueTurn) {
-        introText->updateText("waiting for RED turn . . .");
+        updateHudText(introText, "waiting for RED turn . . .");
         player2->setMoveState(true); // player 1 can move
         player->setMoveState(false); // player 1 cannot move
 
@@ -724,19 +868,26 @@ void gamePlayScene::handleGameEvents() {
             FlagSystem::gameScene1Flags.playerRedTurn = true; // set player 1's turn
             FlagSystem::gameScene1Flags.moved = false; // reset moved flag
             FlagSystem::gameScene1Flags.stickPlaced = false; // reset stick placed flag
+            boardTileMap->getBoardState().setSideToMove(rules::Side::BLUE);
         }
 
-        if(boardTileMap->isP1StartTile(boardTileMap->getTileIndex(player2->getSpritePos()))) {
+        std::optional<size_t> player2TileIndex = boardTileMap->getTileIndex(player2->getSpritePos());
+        if(player2TileIndex && boardTileMap->isP1StartTile(*player2TileIndex)) {
             FlagSystem::flagEvents.gameEnd = true; // player 2 reached goal tile
             backgroundBigFinal->setVisibleState(true); // show final background
             backgroundBig->setVisibleState(false); // hide initial background
-            introText->updateText("Player red wins!");
+            updateHudText(introText, "Player red wins!");
 
             endingText->setVisibleState(true);
         }
     }
 } 
 
+// hud layer only redraws when one of its texts actually changed
+void gamePlayScene::updateHudText(std::unique_ptr<TextClass>& text, const std::string& message) {
+    if (text && text->updateText(message)) hudLayer.invalidate();
+}
+
 void gamePlayScene::update() {
     try {
         changeAnimation();
@@ -775,31 +926,31 @@ void gamePlayScene::drawInleftView(){
 
     drawVisibleObject(scoreText); 
 
-    if(pawnRedBlocked){
-        drawVisibleObject(pawn2);
-        drawVisibleObject(backgroundBigHalfRed);
-        window.draw(wallLine);
-    } else {
-        window.draw(wallLine);
-        drawVisibleObject(pawn2);
-    }
+    window.draw(wallLine);
+    window.draw(pawnSlices, pawn2->returnSpritesShape().getTexture()); // only the columns in front of the walls
     drawVisibleObject(endingText);
 }
 
 void gamePlayScene::drawInmiddleView(){
     window.setView(MetaComponents::middleView);
 
-    drawVisibleObject(boardTileMap); 
-
-    for(const auto& stick : sticksBlue) drawVisibleObject(stick);
-    for(const auto& stick : sticksRed) drawVisibleObject(stick);
+    // board and the sticks that can't move anymore, the next stick of each side follows the mouse so it stays live
+    boardLayer.draw(window, [this](sf::RenderTarget& target) {
+        drawVisibleObject(target, boardTileMap); 
+        for(size_t i = 0; i < sticksBlue.size(); ++i) if (i != stickIndexBlue) drawVisibleObject(target, sticksBlue[i]);
+        for(size_t i = 0; i < sticksRed.size(); ++i) if (i != stickIndexRed) drawVisibleObject(target, sticksRed[i]);
+    });
+    if (stickIndexBlue < sticksBlue.size()) drawVisibleObject(sticksBlue[stickIndexBlue]);
+    if (stickIndexRed < sticksRed.size()) drawVisibleObject(sticksRed[stickIndexRed]);
 
     drawVisibleObject(player);
     drawVisibleObject(player2);
 
-    drawVisibleObject(player1Text);
-    drawVisibleObject(player2Text);
-    drawVisibleObject(introText);
+    hudLayer.draw(window, [this](sf::RenderTarget& target) {
+        drawVisibleObject(target, player1Text);
+        drawVisibleObject(target, player2Text);
+        drawVisibleObject(target, introText);
+    });
 
 }
 
@@ -809,14 +960,8 @@ void gamePlayScene::drawInRightView(){
     drawVisibleObject(backgroundBig);
     drawVisibleObject(backgroundBigFinal);
 
-    if(pawnBlueBlocked){
-        drawVisibleObject(pawn);
-        drawVisibleObject(backgroundBigHalfBlue);
-        window.draw(wallLine2);
-    } else {
-        window.draw(wallLine2);
-        drawVisibleObject(pawn); 
-    }
+    window.draw(wallLine2);
+    window.draw(pawnSlices2, pawn->returnSpritesShape().getTexture());
 
     drawVisibleObject(endingText);
 
@@ -7,6 +7,8 @@
 #include <vector>
 #include <memory>
 #include <array>
+#include <future>
+#include <optional>
 
 #include "../test-assets/sound/sound.hpp"      
 #include "../test-assets/fonts/fonts.hpp"      
@@ -14,6 +16,7 @@
 #include "../physics/physics.hpp"             
 #include "../utils/utils.hpp"                 
 #include "../camera/window.hpp"
+#include "../ai/ai.hpp"
 
 // Base scene class 
 class Scene {
@@ -48,6 +51,8 @@ protected:
 
   template<typename drawableType>
   void drawVisibleObject(drawableType& drawable){ if (drawable && drawable->getVisibleState()) window.draw(*drawable); }
+  template<typename drawableType>
+  void drawVisibleObject(sf::RenderTarget& target, drawableType& drawable){ if (drawable && drawable->getVisibleState()) target.draw(*drawable); }
 
   physics::Quadtree quadtree; 
 };
@@ -102,6 +107,7 @@ private:
 class gamePlayScene : public virtual Scene{
 public:
   gamePlayScene(sf::RenderWindow& gameWindow);
+  ~gamePlayScene() override;
   void createAssets() override; 
 
 private:
@@ -109,17 +115,28 @@ private:
   void insertItemsInQuadtree() override; 
 
   void handleInput() override; 
-  //bool playerHasExit(const std::unique_ptr<Player>& currentPlayer, bool isPlayer1) const;
+  bool playerHasExit(const rules::Move& wallMove, bool isPlayer1) const;
+  rules::Side getMovingSide() const; // engine side of whoever's turn it is
   void handleMouseKey(); 
   void handleSpaceKey();
   void handleMovementKeys(); 
   void handleEachPlayer(std::unique_ptr<Player>& playerNum, std::unique_ptr<Player>& playerToCheck, size_t& moveCount, unsigned int& prevPathIndex);
 
+  // computer opponent ("1 comp" mode)
+  void startComputerOpponent(); // first run after the lobby picked "1 comp"
+  void stopComputerOpponent(); // waits out a running search before dropping the engine
+  bool isComputerTurn() const;
+  void handleComputerTurn(); // starts a background search on its turn, plays the move once it's ready
+  std::optional<rules::Move> getBestComputerStep(const rules::BoardState& position) const;
+  void applyComputerMove(const rules::Move& move);
+  void moveComputerPawn(size_t tileIndex);
+
   void respawnAssets() override; 
 
   void setTime() override;
 
   void handleGameEvents() override; 
+  void updateHudText(std::unique_ptr<TextClass>& text, const std::string& message);
 
   void update() override; 
   void changeAnimation();
@@ -138,8 +155,6 @@ private:
   std::unique_ptr<Sprite> pawn2; // for 3D rendering purposes; pawn is not player and is a red sprite
   std::unique_ptr<Sprite> backgroundBig; 
   std::unique_ptr<Sprite> backgroundBigFinal; 
-  std::unique_ptr<Sprite> backgroundBigHalfRed; // for 3D rendering
-  std::unique_ptr<Sprite> backgroundBigHalfBlue; // for 3D rendering
 
   std::array<std::unique_ptr<Sprite>, Constants::STICKS_NUMBER / 2> sticksBlue;
   std::array<std::unique_ptr<Sprite>, Constants::STICKS_NUMBER / 2> sticksRed;
@@ -152,6 +167,13 @@ private:
   sf::VertexArray wallLine; // player 1
   sf::VertexArray rays2; // player 2
   sf::VertexArray wallLine2; // player 2
+  sf::VertexArray pawnSlices; // red pawn in player 1's view, cut per column against the walls
+  sf::VertexArray pawnSlices2; // blue pawn in player 2's view
+  raycast::RayFan rayFan; // per view so both can be cast at once
+  raycast::RayFan rayFan2;
+  physics::RayCastCache rayCache; // skips views that didn't change since the last frame
+  physics::RayCastCache rayCache2;
+  utils::JobPool viewJobs; // persistent workers for the per frame raycasts
 
   std::unique_ptr<MusicClass> backgroundMusic;
   std::unique_ptr<SoundClass> buttonClickSound; 
@@ -162,14 +184,18 @@ private:
   std::unique_ptr<TextClass> player1Text; // for player 1
   std::unique_ptr<TextClass> player2Text; // for player 2
 
+  CachedLayer boardLayer; // board and settled sticks, redrawn when a wall goes down
+  CachedLayer hudLayer; // middle view texts, redrawn when one of them changes
+
   unsigned int stickIndexBlue{}; 
   unsigned int stickIndexRed{};
 
+  std::unique_ptr<ai::MoveSource> computerPlayer; // null unless playing against the computer
+  std::future<ai::SearchResult> computerSearch; // pending search, valid while the computer is thinking
+  rules::Side computerSide = rules::Side::RED;
+
   size_t p1pathCount{};
   unsigned int p1PrevPathIndex{};
   size_t p2pathCount{};
   unsigned int p2PrevPathIndex{};
-
-  bool pawnRedBlocked = false; // for player 2
-  bool pawnBlueBlocked = false; // for player 1
 };
@@ -5,6 +5,9 @@
 
 #include "utils.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 namespace utils {
     std::vector<std::weak_ptr<unsigned char[]>> convertToWeakPtrVector(const std::vector<std::shared_ptr<unsigned char[]>>& bitMask) {
         std::vector<std::weak_ptr<unsigned char[]>> result;
@@ -17,4 +20,75 @@ namespace utils {
 
         return result;
     }
+
+    JobPool::JobPool(unsigned int workerCount) {
+        if (workerCount == 0) {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            workerCount = hardware > 1 ? hardware - 1 : 0;
+        }
+        workers.reserve(workerCount);
+        for (unsigned int i = 0; i < workerCount; ++i) workers.emplace_back(&JobPool::workerLoop, this);
+    }
+
+    JobPool::~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    void JobPool::parallelFor(size_t jobCount, const std::function<void(size_t)>& job) {
+        if (jobCount == 0) return;
+        if (workers.empty() || jobCount == 1) {
+            for (size_t i = 0; i < jobCount; ++i) job(i);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return activeWorkers == 0; }); // a late worker from the last batch must not claim from this one
+            currentJob = &job;
+            currentCount = jobCount;
+            nextJob.store(0, std::memory_order_relaxed);
+            finishedJobs.store(0, std::memory_order_relaxed);
+            ++generation;
+        }
+        wake.notify_all();
+
+        runJobs(&job, jobCount);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this, jobCount] { return finishedJobs.load(std::memory_order_acquire) == jobCount && activeWorkers == 0; });
+    }
+
+    void JobPool::runJobs(const std::function<void(size_t)>* job, size_t jobCount) {
+        size_t finished = 0;
+        for (size_t index = nextJob.fetch_add(1, std::memory_order_relaxed); index < jobCount; index = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+            (*job)(index);
+            ++finished;
+        }
+        if (finished) finishedJobs.fetch_add(finished, std::memory_order_acq_rel);
+    }
+
+    void JobPool::workerLoop() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            const std::function<void(size_t)>* job = currentJob; // may belong to a batch that already finished, then nothing is left to claim
+            size_t jobCount = currentCount;
+            ++activeWorkers;
+            lock.unlock();
+
+            runJobs(job, jobCount);
+
+            lock.lock();
+            --activeWorkers;
+            if (activeWorkers == 0) done.notify_all();
+        }
+    }
 }
@@ -8,9 +8,45 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 /* utils namespace includes a convertToWeakPtrVector to convert shared_ptr vectors into weak_ptr vectors */
 namespace utils {
     // for sprite consturction 
     std::vector<std::weak_ptr<unsigned char[]>> convertToWeakPtrVector(const std::vector<std::shared_ptr<unsigned char[]>>& bitMask);
+
+    // Persistent workers for fork-join work inside a frame, so nothing spawns threads per call. parallelFor hands out
+    // job indices from a shared counter, the caller works too and it only returns once every job has finished.
+    class JobPool {
+    public:
+        explicit JobPool(unsigned int workerCount = 0); // 0 takes one per hardware thread, minus the caller's
+        ~JobPool();
+        JobPool(const JobPool&) = delete;
+        JobPool& operator=(const JobPool&) = delete;
+
+        void parallelFor(size_t jobCount, const std::function<void(size_t)>& job); // job(0) .. job(jobCount - 1), any order, any thread
+        unsigned int getWorkerCount() const { return static_cast<unsigned int>(workers.size()); }
+
+    private:
+        void workerLoop();
+        void runJobs(const std::function<void(size_t)>* job, size_t jobCount); // claims indices until they run out
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake; // new batch or shutdown
+        std::condition_variable done; // batch finished and every worker left it
+        const std::function<void(size_t)>* currentJob = nullptr;
+        size_t currentCount = 0;
+        std::atomic<size_t> nextJob { 0 };
+        std::atomic<size_t> finishedJobs { 0 };
+        uint64_t generation = 0; // bumped per batch, workers compare it to the last one they ran
+        unsigned int activeWorkers = 0; // workers inside the current batch, guarded by mutex
+        bool stopping = false;
+    };
 }